@@ -0,0 +1,65 @@
+// bench_filter.cpp
+#include "spas_filter168.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// --- Benchmark Framework ---
+
+// Fill a block with deterministic fractions in (-0.5, 0.5) that carry a 'small' tail
+spas_soa168_t make_block(size_t n, uint64_t seed) {
+    spas_soa168_t t(n);
+    uint64_t x = seed;
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        t.set(i, spas_fract168_t((x & 0x2) ? 0b1001 : 0b0000, x >> 2, (uint32_t)(x & 0x3F), x | 0x8000000000000000ULL));
+    }
+    return t;
+}
+
+template <typename F>
+void report(const std::string& name, size_t samples, F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << samples << " samples in " << elapsed.count() << " s, "
+              << samples / elapsed.count() << " samples/s\n";
+}
+
+int main(int argc, char** argv) {
+    size_t samples = (argc > 1) ? std::stoul(argv[1]) : 65536;
+    const size_t block = 1024;
+    spas_soa168_t in = make_block(block, 0x9E3779B97F4A7C15ULL);
+    spas_soa168_t out;
+
+    std::cout << "Starting spas_fract168_t filter benchmark...\n";
+
+    // 64 taps scaled so the output stays in (-1.0, 1.0)
+    spas_soa168_t taps = make_block(64, 0xD1B54A32D192ED03ULL);
+    for (size_t i = 0; i < taps.size(); i++) { taps.big[i] >>= 6; }
+    spas_fir168_t fir(taps);
+    report("FIR 64 taps", samples, [&]() {
+        for (size_t done = 0; done < samples; done += block) { fir.process(in, out); }
+    });
+
+    // 4 stable low-pass sections, coefficients divided by 2
+    spas_soa168_t coefficients;
+    for (int s = 0; s < 4; s++) {
+        coefficients.push_back(spas_fract168_t(0.0200833656 / 2));
+        coefficients.push_back(spas_fract168_t(0.0401667312 / 2));
+        coefficients.push_back(spas_fract168_t(0.0200833656 / 2));
+        coefficients.push_back(spas_fract168_t(-1.5610180758 / 2));
+        coefficients.push_back(spas_fract168_t(0.6413515381 / 2));
+    }
+    spas_iir168_t iir(coefficients, 1);
+    report("IIR 4 biquads", samples, [&]() {
+        for (size_t done = 0; done < samples; done += block) { iir.process(in, out); }
+    });
+
+    spas_soa168_t x = make_block(samples / 16, 0x2545F4914F6CDD1DULL);
+    spas_soa168_t h = make_block(256, 0x94D049BB133111EBULL);
+    for (size_t i = 0; i < h.size(); i++) { h.big[i] >>= 8; }
+    report("Convolution 256 taps", x.size() + h.size() - 1, [&]() { spas_convolve(x, h, out, 0); });
+
+    return 0;
+}
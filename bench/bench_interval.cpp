@@ -0,0 +1,54 @@
+// bench_interval.cpp
+#include "spas_interval168.hpp"
+#include "spas_accum168.hpp"
+#include "spas_random168.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// --- Benchmark Framework ---
+
+template <typename F>
+double report(const std::string& name, size_t n, F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << n << " products in " << elapsed.count() << " s, "
+              << n / elapsed.count() << " products/s\n";
+    return elapsed.count();
+}
+
+int main(int argc, char** argv) {
+    size_t n = (argc > 1) ? std::stoul(argv[1]) : (1 << 18);
+
+    std::cout << "Starting spas_interval168_t benchmark...\n";
+
+    spas_rng168_t rng(1);
+    spas_soa168_t x, y, out(n);
+    rng.uniform(x, n, true);
+    rng.uniform(y, n, true);
+
+    // Narrow intervals around each point, widened by one bit of 'small'
+    spas_interval_soa168_t a(n), b(n), r;
+    for (size_t i = 0; i < n; i++) {
+        spas_fract168_t ulp(0, 0, 0, 1);
+        a.set(i, spas_interval168_t(sub_down(x.get(i), ulp), add_up(x.get(i), ulp)));
+        b.set(i, spas_interval168_t(sub_down(y.get(i), ulp), add_up(y.get(i), ulp)));
+    }
+
+    report("Point operator*", n, [&]() {
+        for (size_t i = 0; i < n; i++) { out.set(i, x.get(i) * y.get(i)); }
+    });
+    double point = report("Point multiply-accumulate", n, [&]() {
+        spas_accum168_t acc;
+        for (size_t i = 0; i < n; i++) {
+            acc.reset();
+            acc.mac(x.get(i), y.get(i));
+            out.set(i, acc.finalize());
+        }
+    });
+    double interval = report("Interval multiply batch", n, [&]() { spas_interval_mul_batch(a, b, r); });
+    std::cout << "Interval / point multiply-accumulate cost: " << interval / point << "\n";
+
+    return 0;
+}
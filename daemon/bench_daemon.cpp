@@ -0,0 +1,149 @@
+// bench_daemon.cpp
+#include "spas_daemon.hpp"
+#include "spas_random168.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// --- Benchmark Framework ---
+
+template <typename F>
+double report(const std::string& name, size_t n, F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << n << " elements in " << elapsed.count() << " s, "
+              << n / elapsed.count() << " elements/s\n";
+    return elapsed.count();
+}
+
+// Error responses are cheap, timing them would overstate the throughput
+void check(const spas_response_t& response) {
+    if (response.status != SPAS_STATUS_OK) {
+        throw std::runtime_error(std::string("daemon job failed: ") + std::string(response.error, strnlen(response.error, sizeof(response.error))));
+    }
+}
+
+// Keep depth requests in flight, the next one is submitted as soon as the oldest completes
+template <typename F>
+void pipeline(spas_client_t& client, size_t jobs, size_t depth, F make) {
+    std::vector<uint32_t> inflight;
+    for (size_t j = 0; j < jobs; j++) {
+        if (inflight.size() == depth) {
+            check(client.wait(inflight.front()));
+            inflight.erase(inflight.begin());
+        }
+        inflight.push_back(client.submit(make(j % depth)));
+    }
+    for (size_t i = 0; i < inflight.size(); i++) check(client.wait(inflight[i]));
+}
+
+int main(int argc, char** argv) {
+    size_t n = (argc > 1) ? std::stoul(argv[1]) : 4096;
+    size_t jobs = (argc > 2) ? std::stoul(argv[2]) : 256;
+    unsigned workers = (argc > 3) ? (unsigned)std::stoul(argv[3]) : 0;
+    const size_t depth = 8, dim = 64;
+
+    std::cout << "Starting spas daemon benchmark...\n";
+
+    std::string path = "/tmp/spas_bench_" + std::to_string(getpid()) + ".sock";
+    pid_t server = fork();
+    if (server == 0) {
+        spas_server_run(path, workers);
+        _exit(0);
+    }
+    spas_client_t* connected = nullptr;
+    for (int attempt = 0; !connected; attempt++) {
+        try {
+            connected = new spas_client_t(path);
+        } catch (const std::runtime_error&) {
+            if (attempt == 200) throw;
+            usleep(10000);
+        }
+    }
+    spas_client_t& client = *connected;
+
+    // Coefficients are kept small so every Horner step stays in (-1.0, 1.0)
+    spas_rng168_t rng(7);
+    spas_soa168_t c, m, x;
+    rng.uniform(c, 9, true);
+    for (size_t i = 0; i < c.size(); i++) c.set(i, c.get(i) * spas_fract168_t(0.0625));
+    rng.uniform(m, dim*dim, true);
+    for (size_t i = 0; i < m.size(); i++) m.set(i, m.get(i) * spas_fract168_t(1.0/256));
+    rng.uniform(x, n, true);
+    spas_poly168_t p(c);
+
+    // Every pipelined slot gets its own input and output region
+    size_t soa = spas_shm_soa_bytes(n), base = spas_shm_soa_bytes(c.size()) + spas_shm_soa_bytes(m.size());
+    uint32_t buffer = client.create_buffer(base + 2*depth*soa);
+    client.write_soa(buffer, 0, c);
+    client.write_soa(buffer, spas_shm_soa_bytes(c.size()), m);
+    for (size_t k = 0; k < depth; k++) client.write_soa(buffer, base + 2*k*soa, x);
+    uint32_t poly = client.load_poly(buffer, 0, c.size());
+    uint32_t matrix = client.load_matrix(buffer, spas_shm_soa_bytes(c.size()), dim, dim);
+
+    // Round trip latency of a single point evaluation
+    std::vector<double> latency;
+    for (size_t i = 0; i < 2000; i++) {
+        auto start = std::chrono::steady_clock::now();
+        client.poly(poly, SPAS_POLY_HORNER, buffer, base, 1, base + soa);
+        latency.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(latency.begin(), latency.end());
+    std::cout << "Single point polynomial round trip: p50 " << latency[latency.size()/2] << " us, p99 "
+              << latency[latency.size()*99/100] << " us\n";
+
+    auto request = [&](spas_job_t job, size_t slot) {
+        spas_request_t q = spas_request_t();
+        q.job = job;
+        q.buffer = buffer;
+        q.n = n;
+        q.in = base + 2*slot*soa;
+        q.out = q.in + soa;
+        return q;
+    };
+
+    spas_soa168_t y;
+    double local = report("In-process polynomial", n*jobs, [&]() {
+        for (size_t j = 0; j < jobs; j++) p.evaluate(x, y, SPAS_POLY_HORNER, 1);
+    });
+    double remote = report("Daemon polynomial", n*jobs, [&]() {
+        pipeline(client, jobs, depth, [&](size_t slot) {
+            spas_request_t q = request(SPAS_JOB_POLY, slot);
+            q.table = poly;
+            q.scheme = SPAS_POLY_HORNER;
+            return q;
+        });
+    });
+    std::cout << "Daemon polynomial speedup over one in-process thread: " << local / remote << "x\n";
+
+    // The sum of n samples has to stay in (-1.0, 1.0), scale them by a power of 2 below 1/n
+    double scale = 1.0;
+    while (scale*n >= 1.0) scale /= 2;
+    spas_soa168_t xr(n);
+    for (size_t i = 0; i < n; i++) xr.set(i, x.get(i) * spas_fract168_t(scale));
+    for (size_t k = 0; k < depth; k++) client.write_soa(buffer, base + 2*k*soa, xr);
+
+    report("Daemon reduce", n*jobs, [&]() {
+        pipeline(client, jobs, depth, [&](size_t slot) { return request(SPAS_JOB_REDUCE, slot); });
+    });
+    report("Daemon gemv", dim*dim*jobs, [&]() {
+        pipeline(client, jobs, depth, [&](size_t slot) {
+            spas_request_t q = request(SPAS_JOB_GEMV, slot);
+            q.table = matrix;
+            return q;
+        });
+    });
+
+    delete connected;
+    kill(server, SIGTERM);
+    waitpid(server, nullptr, 0);
+    return 0;
+}
@@ -0,0 +1,18 @@
+// server_main.cpp
+#include "spas_daemon.hpp"
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    std::string path = (argc > 1) ? argv[1] : "/tmp/spas_daemon.sock";
+    unsigned workers = (argc > 2) ? (unsigned)std::stoul(argv[2]) : 0;
+
+    std::cout << "spas daemon listening on " << path << "\n";
+    try {
+        spas_server_run(path, workers);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
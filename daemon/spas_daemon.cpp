@@ -0,0 +1,261 @@
+#include "spas_daemon.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Shared memory layout
+size_t spas_shm_soa_bytes(size_t n){
+    return (21*n + 7) & ~(size_t)7;
+}
+
+void spas_shm_store(void* dst, const spas_soa168_t& t){
+    size_t n = t.size();
+    unsigned char* p = (unsigned char*)dst;
+    memcpy(p, t.big.data(), 8*n);
+    memcpy(p+8*n, t.small.data(), 8*n);
+    memcpy(p+16*n, t.offset.data(), 4*n);
+    memcpy(p+20*n, t.sign.data(), n);
+}
+
+void spas_shm_load(const void* src, size_t n, spas_soa168_t& t){
+    const unsigned char* p = (const unsigned char*)src;
+    t.resize(n);
+    memcpy(t.big.data(), p, 8*n);
+    memcpy(t.small.data(), p+8*n, 8*n);
+    memcpy(t.offset.data(), p+16*n, 4*n);
+    memcpy(t.sign.data(), p+20*n, n);
+}
+
+spas_soa168_view_t spas_shm_view(const void* src, size_t n){
+    const unsigned char* p = (const unsigned char*)src;
+    return spas_soa168_view_t(p+20*n, (const uint64_t*)p, (const uint64_t*)(p+8*n), (const uint32_t*)(p+16*n), n);
+}
+
+spas_soa168_span_t spas_shm_span(void* dst, size_t n){
+    unsigned char* p = (unsigned char*)dst;
+    return spas_soa168_span_t(p+20*n, (uint64_t*)p, (uint64_t*)(p+8*n), (uint32_t*)(p+16*n), n);
+}
+
+// Constructors
+spas_client_t::spas_client_t(const std::string& path){
+    this->next_id = 1;
+    this->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(this->fd < 0){
+        throw std::runtime_error("spas_client_t failed to create a socket!");
+    }
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(addr.sun_path)){
+        close(this->fd);
+        throw std::runtime_error("spas_client_t socket path is too long!");
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    if(connect(this->fd, (sockaddr*)&addr, sizeof(addr)) < 0){
+        close(this->fd);
+        throw std::runtime_error("spas_client_t failed to connect to " + path + "!");
+    }
+}
+
+spas_client_t::~spas_client_t(){
+    close(this->fd);
+    for(std::map<uint32_t, shm_buffer_t>::iterator it=this->buffers.begin(); it!=this->buffers.end(); ++it){
+        munmap(it->second.data, it->second.bytes);
+    }
+}
+
+// Shared memory buffers
+uint32_t spas_client_t::create_buffer(size_t bytes){
+    // The memory is sealed against shrinking, the daemon refuses anything else
+#if defined(MFD_ALLOW_SEALING) && defined(F_SEAL_SHRINK)
+    int shm = memfd_create("spas", MFD_ALLOW_SEALING | MFD_CLOEXEC);
+    if(shm < 0){
+        throw std::runtime_error("spas_client_t failed to create shared memory!");
+    }
+    if(ftruncate(shm, bytes) < 0 || fcntl(shm, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_SEAL) < 0){
+        close(shm);
+        throw std::runtime_error("spas_client_t failed to size shared memory!");
+    }
+#else
+    int shm = -1;
+    throw std::runtime_error("spas_client_t needs memfd_create() with file seals!");
+#endif
+    void* data = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm, 0);
+    if(data == MAP_FAILED){
+        close(shm);
+        throw std::runtime_error("spas_client_t failed to map shared memory!");
+    }
+
+    spas_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.job = SPAS_JOB_REGISTER;
+    request.id = this->next_id++;
+    request.n = bytes;
+    this->send_request(request, shm);
+    close(shm);
+
+    uint32_t buffer;
+    try{
+        buffer = (uint32_t)this->expect(request.id);
+    }
+    catch(...){
+        munmap(data, bytes);
+        throw;
+    }
+    shm_buffer_t t = {data, bytes};
+    this->buffers[buffer] = t;
+    return buffer;
+}
+
+void* spas_client_t::buffer_data(uint32_t buffer) const{
+    std::map<uint32_t, shm_buffer_t>::const_iterator it = this->buffers.find(buffer);
+    if(it == this->buffers.end()){
+        throw std::invalid_argument("spas_client_t unknown buffer!");
+    }
+    return it->second.data;
+}
+
+void spas_client_t::write_soa(uint32_t buffer, size_t offset, const spas_soa168_t& t){
+    std::map<uint32_t, shm_buffer_t>::const_iterator it = this->buffers.find(buffer);
+    if(it == this->buffers.end() || offset > it->second.bytes || spas_shm_soa_bytes(t.size()) > it->second.bytes - offset){
+        throw std::invalid_argument("spas_client_t write out of buffer bounds!");
+    }
+    spas_shm_store((unsigned char*)it->second.data + offset, t);
+}
+
+void spas_client_t::read_soa(uint32_t buffer, size_t offset, size_t n, spas_soa168_t& t) const{
+    std::map<uint32_t, shm_buffer_t>::const_iterator it = this->buffers.find(buffer);
+    if(it == this->buffers.end() || offset > it->second.bytes || spas_shm_soa_bytes(n) > it->second.bytes - offset){
+        throw std::invalid_argument("spas_client_t read out of buffer bounds!");
+    }
+    spas_shm_load((const unsigned char*)it->second.data + offset, n, t);
+}
+
+// Requests
+void spas_client_t::send_request(const spas_request_t& request, int fd_pass){
+    iovec iov;
+    iov.iov_base = (void*)&request;
+    iov.iov_len = sizeof(request);
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    char control[CMSG_SPACE(sizeof(int))];
+    if(fd_pass >= 0){
+        memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &fd_pass, sizeof(int));
+    }
+
+    // The descriptor goes with the first byte, the rest of a short write is sent plainly
+    ssize_t sent = sendmsg(this->fd, &msg, MSG_NOSIGNAL);
+    while(sent >= 0 && (size_t)sent < sizeof(request)){
+        ssize_t r = send(this->fd, (const char*)&request + sent, sizeof(request) - sent, MSG_NOSIGNAL);
+        sent = (r < 0) ? r : sent + r;
+    }
+    if(sent < 0){
+        throw std::runtime_error("spas_client_t lost the connection to the daemon!");
+    }
+}
+
+uint32_t spas_client_t::submit(spas_request_t request){
+    request.id = this->next_id++;
+    this->send_request(request, -1);
+    return request.id;
+}
+
+spas_response_t spas_client_t::wait(uint32_t id){
+    while(this->responses.find(id) == this->responses.end()){
+        spas_response_t response;
+        size_t got = 0;
+        while(got < sizeof(response)){
+            ssize_t r = recv(this->fd, (char*)&response + got, sizeof(response) - got, 0);
+            if(r < 0 && errno == EINTR){continue;}
+            if(r <= 0){
+                throw std::runtime_error("spas_client_t lost the connection to the daemon!");
+            }
+            got += r;
+        }
+        this->responses[response.id] = response;
+    }
+    spas_response_t response = this->responses[id];
+    this->responses.erase(id);
+    return response;
+}
+
+uint64_t spas_client_t::expect(uint32_t id){
+    spas_response_t response = this->wait(id);
+    if(response.status != SPAS_STATUS_OK){
+        response.error[sizeof(response.error)-1] = 0;
+        throw std::runtime_error(std::string("spas daemon: ") + response.error);
+    }
+    return response.value;
+}
+
+uint32_t spas_client_t::load_poly(uint32_t buffer, size_t offset, size_t n){
+    spas_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.job = SPAS_JOB_LOAD_POLY;
+    request.buffer = buffer;
+    request.in = offset;
+    request.n = n;
+    return (uint32_t)this->expect(this->submit(request));
+}
+
+uint32_t spas_client_t::load_matrix(uint32_t buffer, size_t offset, size_t rows, size_t cols){
+    spas_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.job = SPAS_JOB_LOAD_MATRIX;
+    request.buffer = buffer;
+    request.in = offset;
+    request.rows = rows;
+    request.cols = cols;
+    return (uint32_t)this->expect(this->submit(request));
+}
+
+void spas_client_t::reduce(uint32_t buffer, size_t in, size_t n, size_t out){
+    spas_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.job = SPAS_JOB_REDUCE;
+    request.buffer = buffer;
+    request.in = in;
+    request.n = n;
+    request.out = out;
+    this->expect(this->submit(request));
+}
+
+void spas_client_t::gemv(uint32_t table, uint32_t buffer, size_t in, size_t out){
+    spas_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.job = SPAS_JOB_GEMV;
+    request.table = table;
+    request.buffer = buffer;
+    request.in = in;
+    request.out = out;
+    this->expect(this->submit(request));
+}
+
+void spas_client_t::poly(uint32_t table, spas_poly_scheme_t scheme, uint32_t buffer, size_t in, size_t n, size_t out){
+    spas_request_t request;
+    memset(&request, 0, sizeof(request));
+    request.job = SPAS_JOB_POLY;
+    request.table = table;
+    request.scheme = scheme;
+    request.buffer = buffer;
+    request.in = in;
+    request.n = n;
+    request.out = out;
+    this->expect(this->submit(request));
+}
@@ -0,0 +1,105 @@
+#ifndef spas_daemon
+#define spas_daemon
+
+#include <map>
+#include <string>
+#include <vector>
+#include "spas_poly168.hpp"
+
+// Wire protocol of the local batch computation daemon
+// Requests and responses are fixed size structs on a Unix domain stream socket, the SoA payloads never go through
+// the socket: they live in shared memory buffers whose file descriptors are passed once with SCM_RIGHTS
+
+enum spas_job_t{
+    SPAS_JOB_REGISTER = 1, // Map the shared memory fd sent along with the request, n is its size in bytes
+                           // The memory has to be sealed with F_SEAL_SHRINK, refused on systems without file seals
+    SPAS_JOB_LOAD_POLY, // Load n coefficients at in as a polynomial table shared by every client
+    SPAS_JOB_LOAD_MATRIX, // Load a rows x cols row-major matrix at in as a table shared by every client
+    SPAS_JOB_REDUCE, // Sum n fractions at in into 1 fraction at out
+    SPAS_JOB_GEMV, // Multiply matrix table by cols fractions at in into rows fractions at out
+    SPAS_JOB_POLY // Evaluate polynomial table at n fractions at in into n fractions at out
+};
+// REDUCE, GEMV and POLY run in place on the shared memory, out may equal in but must not partially overlap it
+
+enum spas_status_t{
+    SPAS_STATUS_OK = 0,
+    SPAS_STATUS_BAD_REQUEST, // Unknown job, buffer or table, or a payload out of the buffer bounds
+    SPAS_STATUS_FAILED // The computation threw, e.g. a result out of (-1.0, 1.0)
+};
+
+struct spas_request_t{
+    uint32_t job; // spas_job_t
+    uint32_t id; // Echoed in the response, requests may be pipelined and answered out of order
+    uint32_t buffer; // Buffer id returned by SPAS_JOB_REGISTER
+    uint32_t table; // Table id returned by SPAS_JOB_LOAD_POLY or SPAS_JOB_LOAD_MATRIX
+    uint32_t scheme; // spas_poly_scheme_t of SPAS_JOB_POLY
+    uint32_t reserved;
+    uint64_t n;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t in; // Byte offset of the input SoA inside the buffer, a multiple of 8
+    uint64_t out; // Byte offset of the output SoA inside the buffer, a multiple of 8
+};
+
+struct spas_response_t{
+    uint32_t id;
+    uint32_t status; // spas_status_t
+    uint64_t value; // Buffer or table id for SPAS_JOB_REGISTER and SPAS_JOB_LOAD_*
+    char error[48];
+};
+
+// Layout of n fractions in shared memory: big[n], small[n], offset[n], sign[n], padded to 8 bytes
+size_t spas_shm_soa_bytes(size_t n);
+void spas_shm_store(void* dst, const spas_soa168_t& t);
+void spas_shm_load(const void* src, size_t n, spas_soa168_t& t);
+// Views of n fractions in that layout without copying, the memory has to be 8 byte aligned
+spas_soa168_view_t spas_shm_view(const void* src, size_t n);
+spas_soa168_span_t spas_shm_span(void* dst, size_t n);
+
+// Client side of the daemon, one connection with its own shared memory buffers
+class spas_client_t{
+    public:
+        // Connect to the daemon listening at path, throws std::runtime_error on failure
+        spas_client_t(const std::string& path);
+        ~spas_client_t();
+
+        // Create a shared memory buffer of the given size and register it with the daemon, return its id
+        uint32_t create_buffer(size_t bytes);
+        // Return the mapped memory of a buffer
+        void* buffer_data(uint32_t buffer) const;
+        // Copy fractions in and out of a buffer at a byte offset
+        void write_soa(uint32_t buffer, size_t offset, const spas_soa168_t& t);
+        void read_soa(uint32_t buffer, size_t offset, size_t n, spas_soa168_t& t) const;
+
+        // Asynchronous interface, submit() fills in the request id and wait() blocks until its response arrives
+        uint32_t submit(spas_request_t request);
+        spas_response_t wait(uint32_t id);
+
+        // Synchronous jobs, throw std::runtime_error when the daemon reports an error
+        uint32_t load_poly(uint32_t buffer, size_t offset, size_t n);
+        uint32_t load_matrix(uint32_t buffer, size_t offset, size_t rows, size_t cols);
+        void reduce(uint32_t buffer, size_t in, size_t n, size_t out);
+        void gemv(uint32_t table, uint32_t buffer, size_t in, size_t out);
+        void poly(uint32_t table, spas_poly_scheme_t scheme, uint32_t buffer, size_t in, size_t n, size_t out);
+
+    private:
+        struct shm_buffer_t{
+            void* data;
+            size_t bytes;
+        };
+
+        int fd;
+        uint32_t next_id;
+        std::map<uint32_t, shm_buffer_t> buffers;
+        std::map<uint32_t, spas_response_t> responses; // Arrived but not waited for yet
+
+        // Send a request, attaching fd_pass when it is not -1
+        void send_request(const spas_request_t& request, int fd_pass);
+        // Wait for a response and throw if it reports an error
+        uint64_t expect(uint32_t id);
+};
+
+// Run the daemon on a Unix domain socket at path with the given number of workers (0 means one per hardware thread)
+// Return when SIGINT or SIGTERM is received, throws std::runtime_error if the socket can't be set up
+void spas_server_run(const std::string& path, unsigned workers);
+#endif
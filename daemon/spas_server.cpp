@@ -0,0 +1,495 @@
+#include "spas_daemon.hpp"
+#include "spas_accum168.hpp"
+#include "spas_parallel.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Thrown for requests the daemon refuses, reported as SPAS_STATUS_BAD_REQUEST
+struct server_bad_request_t : std::runtime_error{
+    server_bad_request_t(const char* what) : std::runtime_error(what){}
+};
+
+struct server_buffer_t{
+    void* data;
+    size_t bytes;
+};
+
+// One client connection, shared with the workers running its jobs so it outlives a disconnect
+struct server_connection_t{
+    int fd;
+    int wake; // Write end of the event loop wake pipe
+    std::mutex buffers_lock;
+    std::vector<server_buffer_t> buffers;
+    std::mutex write_lock;
+    std::string outbuf; // Responses not taken by the socket yet, from outpos on
+    size_t outpos;
+    std::deque<int> fds; // Received but not registered yet, event loop only
+    std::string inbuf; // Partial request bytes, event loop only
+
+    server_connection_t(int fd, int wake) : fd(fd), wake(wake), outpos(0){}
+    ~server_connection_t(){
+        close(this->fd);
+        for(size_t i=0; i<this->buffers.size(); i++){
+            munmap(this->buffers[i].data, this->buffers[i].bytes);
+        }
+        for(size_t i=0; i<this->fds.size(); i++){
+            close(this->fds[i]);
+        }
+    }
+
+    // Return the memory of [offset, offset+bytes) inside a registered buffer
+    unsigned char* view(uint32_t buffer, uint64_t offset, uint64_t bytes){
+        std::lock_guard<std::mutex> guard(this->buffers_lock);
+        if(buffer >= this->buffers.size()){
+            throw server_bad_request_t("unknown buffer");
+        }
+        const server_buffer_t& b = this->buffers[buffer];
+        if(offset > b.bytes || bytes > b.bytes - offset){
+            throw server_bad_request_t("payload out of buffer bounds");
+        }
+        return (unsigned char*)b.data + offset;
+    }
+
+    // Queue a response, it goes out right away if the socket has room and the event loop sends the rest on POLLOUT
+    // Responses are never dropped or cut, the stream of fixed size responses stays in step however slow the client reads
+    void respond(const spas_response_t& response){
+        std::lock_guard<std::mutex> guard(this->write_lock);
+        this->outbuf.append((const char*)&response, sizeof(response));
+        if(!this->flush_locked()){
+            char c = 0;
+            ssize_t r = write(this->wake, &c, 1); // A full pipe already has the loop awake
+            (void)r;
+        }
+    }
+
+    // Send queued responses from the event loop
+    void flush(){
+        std::lock_guard<std::mutex> guard(this->write_lock);
+        this->flush_locked();
+    }
+
+    bool pending(){
+        std::lock_guard<std::mutex> guard(this->write_lock);
+        return this->outpos < this->outbuf.size();
+    }
+
+    private:
+        // Send as much as the socket takes without blocking, return true once nothing is left
+        bool flush_locked(){
+            while(this->outpos < this->outbuf.size()){
+                ssize_t r = send(this->fd, this->outbuf.data() + this->outpos, this->outbuf.size() - this->outpos, MSG_NOSIGNAL);
+                if(r >= 0){
+                    this->outpos += r;
+                    continue;
+                }
+                if(errno == EINTR){continue;}
+                if(errno == EAGAIN || errno == EWOULDBLOCK){break;}
+                this->outpos = this->outbuf.size(); // Client is gone, nobody will read the rest
+            }
+            if(this->outpos == this->outbuf.size()){
+                this->outbuf.clear();
+                this->outpos = 0;
+            }
+            else if(this->outpos > this->outbuf.size()/2){ // Compact once the sent part dominates
+                this->outbuf.erase(0, this->outpos);
+                this->outpos = 0;
+            }
+            return this->outbuf.empty();
+        }
+};
+
+// Coefficient table loaded once and shared by every client
+struct server_table_t{
+    size_t rows;
+    size_t cols;
+    spas_soa168_t matrix; // Row-major, SPAS_JOB_LOAD_MATRIX only
+    std::shared_ptr<spas_poly168_t> poly; // SPAS_JOB_LOAD_POLY only
+};
+
+struct server_job_t{
+    std::shared_ptr<server_connection_t> connection;
+    spas_request_t request;
+};
+
+struct server_state_t{
+    std::mutex queue_lock;
+    std::condition_variable queue_ready;
+    std::deque<server_job_t> queue;
+    bool stopping;
+
+    std::mutex tables_lock;
+    std::vector<std::shared_ptr<const server_table_t> > tables;
+};
+
+static volatile sig_atomic_t server_stop = 0;
+
+static void server_signal(int){
+    server_stop = 1;
+}
+
+static spas_response_t make_response(uint32_t id, uint32_t status, const char* error){
+    spas_response_t response;
+    memset(&response, 0, sizeof(response));
+    response.id = id;
+    response.status = status;
+    if(error){
+        strncpy(response.error, error, sizeof(response.error)-1);
+    }
+    return response;
+}
+
+// Map a payload of n fractions, guarding the size computation against overflow
+static unsigned char* soa_view(server_connection_t& c, uint32_t buffer, uint64_t offset, uint64_t n){
+    if(n > ((uint64_t)1 << 56)){
+        throw server_bad_request_t("payload too large");
+    }
+    if(offset % 8){ // The kernels read the words straight from the mapping
+        throw server_bad_request_t("payload is not 8 byte aligned");
+    }
+    return c.view(buffer, offset, spas_shm_soa_bytes(n));
+}
+
+// Jobs run in place, out may be in itself but any other overlap would overwrite inputs still to be read
+static void check_disjoint(uint64_t in, uint64_t n_in, uint64_t out, uint64_t n_out, bool same_allowed){
+    if(same_allowed && in == out && n_in == n_out){return;}
+    if(in < out + spas_shm_soa_bytes(n_out) && out < in + spas_shm_soa_bytes(n_in)){
+        throw server_bad_request_t("output overlaps the input");
+    }
+}
+
+static std::shared_ptr<const server_table_t> find_table(server_state_t& s, uint32_t table){
+    std::lock_guard<std::mutex> guard(s.tables_lock);
+    if(table >= s.tables.size()){
+        throw server_bad_request_t("unknown table");
+    }
+    return s.tables[table];
+}
+
+static uint32_t add_table(server_state_t& s, const std::shared_ptr<const server_table_t>& t){
+    std::lock_guard<std::mutex> guard(s.tables_lock);
+    s.tables.push_back(t);
+    return (uint32_t)(s.tables.size()-1);
+}
+
+// Run one job on a worker, the kernels read and write the shared memory in place
+static void run_job(server_state_t& s, server_job_t& job){
+    const spas_request_t& q = job.request;
+    server_connection_t& c = *job.connection;
+    spas_response_t response = make_response(q.id, SPAS_STATUS_OK, NULL);
+
+    try{
+        switch(q.job){
+            case SPAS_JOB_LOAD_POLY:{
+                spas_soa168_t coefficients; // Tables outlive the request, so they are copied out
+                spas_shm_load(soa_view(c, q.buffer, q.in, q.n), q.n, coefficients);
+                std::shared_ptr<server_table_t> t = std::make_shared<server_table_t>();
+                t->rows = 1;
+                t->cols = q.n;
+                t->poly = std::make_shared<spas_poly168_t>(coefficients);
+                response.value = add_table(s, t);
+                break;
+            }
+            case SPAS_JOB_LOAD_MATRIX:{
+                if(q.rows == 0 || q.cols == 0 || q.rows > ((uint64_t)1 << 56)/q.cols){
+                    throw server_bad_request_t("bad matrix shape");
+                }
+                std::shared_ptr<server_table_t> t = std::make_shared<server_table_t>();
+                t->rows = q.rows;
+                t->cols = q.cols;
+                spas_shm_load(soa_view(c, q.buffer, q.in, q.rows*q.cols), q.rows*q.cols, t->matrix);
+                response.value = add_table(s, t);
+                break;
+            }
+            case SPAS_JOB_REDUCE:{
+                spas_soa168_view_t x = spas_shm_view(soa_view(c, q.buffer, q.in, q.n), q.n);
+                spas_soa168_span_t y = spas_shm_span(soa_view(c, q.buffer, q.out, 1), 1);
+                spas_accum168_t acc;
+                for(size_t i=0; i<x.size(); i++){
+                    acc += x.get(i);
+                }
+                y.set(0, acc.finalize()); // Every input is read by now, out may lie anywhere
+                break;
+            }
+            case SPAS_JOB_GEMV:{
+                std::shared_ptr<const server_table_t> t = find_table(s, q.table);
+                if(t->poly){
+                    throw server_bad_request_t("table is not a matrix");
+                }
+                check_disjoint(q.in, t->cols, q.out, t->rows, false); // Every row reads all of in
+                spas_soa168_view_t x = spas_shm_view(soa_view(c, q.buffer, q.in, t->cols), t->cols);
+                spas_soa168_span_t y = spas_shm_span(soa_view(c, q.buffer, q.out, t->rows), t->rows);
+                spas_accum168_t acc;
+                for(size_t r=0; r<t->rows; r++){
+                    acc.reset();
+                    acc.mac_batch(t->matrix, r*t->cols, x, 0, t->cols);
+                    y.set(r, acc.finalize());
+                }
+                break;
+            }
+            case SPAS_JOB_POLY:{
+                std::shared_ptr<const server_table_t> t = find_table(s, q.table);
+                if(!t->poly){
+                    throw server_bad_request_t("table is not a polynomial");
+                }
+                if(q.scheme != SPAS_POLY_HORNER && q.scheme != SPAS_POLY_ESTRIN){
+                    throw server_bad_request_t("unknown scheme");
+                }
+                check_disjoint(q.in, q.n, q.out, q.n, true);
+                spas_soa168_view_t x = spas_shm_view(soa_view(c, q.buffer, q.in, q.n), q.n);
+                spas_soa168_span_t y = spas_shm_span(soa_view(c, q.buffer, q.out, q.n), q.n);
+                t->poly->evaluate(x, y, (spas_poly_scheme_t)q.scheme, 1);
+                break;
+            }
+            default:
+                throw server_bad_request_t("unknown job");
+        }
+    }
+    catch(const server_bad_request_t& e){
+        response = make_response(q.id, SPAS_STATUS_BAD_REQUEST, e.what());
+    }
+    catch(const std::exception& e){
+        response = make_response(q.id, SPAS_STATUS_FAILED, e.what());
+    }
+    c.respond(response);
+}
+
+static void worker(server_state_t& s){
+    while(true){
+        server_job_t job;
+        {
+            std::unique_lock<std::mutex> guard(s.queue_lock);
+            s.queue_ready.wait(guard, [&s](){ return s.stopping || !s.queue.empty(); });
+            if(s.queue.empty()){return;}
+            job = s.queue.front();
+            s.queue.pop_front();
+        }
+        run_job(s, job);
+    }
+}
+
+// Map the shared memory sent along with a SPAS_JOB_REGISTER, done on the event loop since it needs the fd queue
+static void register_buffer(server_connection_t& c, const spas_request_t& q){
+    if(c.fds.empty()){
+        c.respond(make_response(q.id, SPAS_STATUS_BAD_REQUEST, "no file descriptor attached"));
+        return;
+    }
+    int shm = c.fds.front();
+    c.fds.pop_front();
+
+    // A client shrinking the memory under a mapping would kill the daemon with SIGBUS at any later access, and no
+    // check before a job can rule that out, so only buffers sealed against shrinking are accepted
+    // Systems without file seals can't register buffers at all
+#if defined(F_SEAL_SHRINK)
+    int seals = fcntl(shm, F_GET_SEALS);
+    if(seals < 0 || !(seals & F_SEAL_SHRINK)){
+        close(shm);
+        c.respond(make_response(q.id, SPAS_STATUS_BAD_REQUEST, "buffer is not sealed against shrinking"));
+        return;
+    }
+#else
+    close(shm);
+    c.respond(make_response(q.id, SPAS_STATUS_BAD_REQUEST, "file seals are not supported"));
+    return;
+#endif
+
+    struct stat st;
+    void* data = MAP_FAILED;
+    if(q.n > 0 && fstat(shm, &st) == 0 && (uint64_t)st.st_size >= q.n){
+        data = mmap(NULL, q.n, PROT_READ | PROT_WRITE, MAP_SHARED, shm, 0);
+    }
+    close(shm); // The mapping keeps the memory alive
+    if(data == MAP_FAILED){
+        c.respond(make_response(q.id, SPAS_STATUS_BAD_REQUEST, "failed to map buffer"));
+        return;
+    }
+
+    spas_response_t response = make_response(q.id, SPAS_STATUS_OK, NULL);
+    {
+        std::lock_guard<std::mutex> guard(c.buffers_lock);
+        server_buffer_t b = {data, q.n};
+        c.buffers.push_back(b);
+        response.value = c.buffers.size()-1;
+    }
+    c.respond(response);
+}
+
+// Drain a readable connection, return false once it is closed
+static bool read_connection(server_state_t& s, const std::shared_ptr<server_connection_t>& c){
+    while(true){
+        char data[4096];
+        char control[CMSG_SPACE(8*sizeof(int))];
+        iovec iov = {data, sizeof(data)};
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t r = recvmsg(c->fd, &msg, 0);
+        if(r < 0){
+            if(errno == EINTR){continue;}
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        for(cmsghdr* cmsg=CMSG_FIRSTHDR(&msg); cmsg; cmsg=CMSG_NXTHDR(&msg, cmsg)){
+            if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS){
+                size_t count = (cmsg->cmsg_len - CMSG_LEN(0))/sizeof(int);
+                for(size_t i=0; i<count; i++){
+                    int fd;
+                    memcpy(&fd, CMSG_DATA(cmsg) + i*sizeof(int), sizeof(int));
+                    c->fds.push_back(fd);
+                }
+            }
+        }
+        if(r == 0){return false;}
+
+        c->inbuf.append(data, r);
+        size_t used = 0;
+        while(c->inbuf.size() - used >= sizeof(spas_request_t)){
+            server_job_t job;
+            memcpy(&job.request, c->inbuf.data() + used, sizeof(spas_request_t));
+            used += sizeof(spas_request_t);
+            if(job.request.job == SPAS_JOB_REGISTER){
+                register_buffer(*c, job.request);
+                continue;
+            }
+            job.connection = c;
+            {
+                std::lock_guard<std::mutex> guard(s.queue_lock);
+                s.queue.push_back(job);
+            }
+            s.queue_ready.notify_one();
+        }
+        c->inbuf.erase(0, used);
+    }
+}
+
+static void set_nonblocking(int fd){
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+void spas_server_run(const std::string& path, unsigned workers){
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(path.size() >= sizeof(addr.sun_path)){
+        throw std::runtime_error("spas_server_run socket path is too long!");
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listener < 0){
+        throw std::runtime_error("spas_server_run failed to create a socket!");
+    }
+    unlink(path.c_str()); // Stale socket of a previous run
+    if(bind(listener, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(listener, 64) < 0){
+        close(listener);
+        throw std::runtime_error("spas_server_run failed to listen on " + path + "!");
+    }
+    set_nonblocking(listener);
+
+    // Workers start with the stop signals blocked so they land on the event loop
+    server_stop = 0;
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = server_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    sigset_t stop_signals, previous;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &previous);
+
+    server_state_t s;
+    s.stopping = false;
+    std::vector<std::thread> pool;
+    workers = spas_thread_count(workers);
+    for(unsigned t=0; t<workers; t++){
+        pool.emplace_back(worker, std::ref(s));
+    }
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+    // Workers with responses the socket could not take wake the loop through this pipe so it polls for POLLOUT
+    int wake[2];
+    if(pipe(wake) < 0){
+        wake[0] = wake[1] = -1;
+    }
+    else{
+        set_nonblocking(wake[0]);
+        set_nonblocking(wake[1]);
+    }
+
+    // Event loop, the timeout catches a stop signal delivered while not in poll
+    std::vector<std::shared_ptr<server_connection_t> > connections;
+    std::vector<pollfd> fds;
+    while(!server_stop){
+        fds.resize(connections.size()+2);
+        fds[0].fd = listener;
+        fds[0].events = POLLIN;
+        fds[1].fd = wake[0];
+        fds[1].events = POLLIN;
+        for(size_t i=0; i<connections.size(); i++){
+            fds[i+2].fd = connections[i]->fd;
+            fds[i+2].events = POLLIN | (connections[i]->pending() ? POLLOUT : 0);
+        }
+        if(poll(fds.data(), fds.size(), 100) <= 0){continue;}
+
+        if(fds[1].revents & POLLIN){
+            char drain[64];
+            while(read(wake[0], drain, sizeof(drain)) > 0){}
+        }
+
+        std::vector<std::shared_ptr<server_connection_t> > alive;
+        for(size_t i=0; i<connections.size(); i++){
+            short revents = fds[i+2].revents;
+            if(revents & POLLOUT){
+                connections[i]->flush();
+            }
+            if(!(revents & (POLLIN | POLLHUP | POLLERR)) || read_connection(s, connections[i])){
+                alive.push_back(connections[i]);
+            }
+        }
+        connections.swap(alive);
+
+        if(fds[0].revents & POLLIN){
+            int fd;
+            while((fd = accept(listener, NULL, NULL)) >= 0){
+                set_nonblocking(fd);
+                connections.push_back(std::make_shared<server_connection_t>(fd, wake[1]));
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(s.queue_lock);
+        s.stopping = true;
+    }
+    s.queue_ready.notify_all();
+    for(size_t i=0; i<pool.size(); i++){
+        pool[i].join();
+    }
+    connections.clear();
+    close(wake[0]);
+    close(wake[1]);
+    close(listener);
+    unlink(path.c_str());
+}
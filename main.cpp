@@ -1,9 +1,26 @@
 // main.cpp
 #include "spas_fract168.hpp"
+#include "spas_accum168.hpp"
+#include "spas_cpu.hpp"
+#include "spas_kernel168.hpp"
+#include "spas_csr168.hpp"
+#include "spas_filter168.hpp"
+#include "spas_qformat168.hpp"
+#include "spas_random168.hpp"
+#include "spas_interval168.hpp"
+#include "spas_poly168.hpp"
+#ifdef SPAS_DAEMON
+#include "spas_daemon.hpp"
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <cmath>
 #include <iomanip>
+#include <vector>
 
 // --- Testing Framework ---
 
@@ -28,6 +45,11 @@ bool operator==(const spas_fract168_t& a, const spas_fract168_t& b) {
            a.offset == b.offset;
 }
 
+// Value equality, ignores the sign of zero portions
+bool same_value(const spas_fract168_t& a, const spas_fract168_t& b) {
+    return spas_accum168_t(a) == spas_accum168_t(b);
+}
+
 // Float equality strictly for resulting value validations
 bool approx_eq(double a, double b) {
     return std::abs(a - b) < 1e-9;
@@ -182,6 +204,734 @@ void test_big_small_cross_interactions() {
                 "Multiplication correctly isolates and distributes negative sign recursively to 'small' cross-terms");
 }
 
+void test_accumulator() {
+    std::cout << "\n--- Testing Unnormalized Accumulator ---\n";
+
+    spas_fract168_t t_m65(0, 0, 0, 0x8000000000000000ULL); // 2^-65
+    spas_accum168_t acc;
+    acc += t_m65;
+    acc += t_m65;
+    assert_test(acc.finalize() == spas_fract168_t(0, 1, 0, 0),
+                "Accumulator carries from 'small' into 'big' on finalize");
+
+    spas_fract168_t q_minus_small(0b0001, 0x4000000000000000ULL, 0, 0x8000000000000000ULL);
+    spas_accum168_t acc_mix(q_minus_small);
+    acc_mix += q_minus_small;
+    assert_test(acc_mix.finalize() == (q_minus_small + q_minus_small),
+                "Accumulator borrows from 'big' like operator+= on mixed-sign states");
+
+    // Long chain with matching offsets is exact for both paths
+    spas_fract168_t step(0, 0x0000000100000000ULL, 3, 0xC000000000000000ULL);
+    spas_fract168_t chain;
+    spas_accum168_t acc_chain;
+    for(int i=0; i<1000; i++){
+        chain += step;
+        acc_chain += step;
+    }
+    assert_test(acc_chain.finalize() == chain, "Accumulator matches operator+= chain of 1000 steps");
+
+    // Misaligned offsets with a negative tail, the dropped bits must not cost a unit of 'small'
+    spas_accum168_t acc_tail(t_m65);
+    acc_tail -= spas_fract168_t(0, 0, 100, 0x8000000000000000ULL);
+    assert_test(acc_tail.finalize() == t_m65 && same_value(acc_tail.finalize(), t_m65 - spas_fract168_t(0, 0, 100, 0x8000000000000000ULL)),
+                "Accumulator rounds a misaligned negative tail to nearest like operator-");
+    spas_accum168_t acc_tail_floor(t_m65, SPAS_ACCUM_FLOOR);
+    acc_tail_floor -= spas_fract168_t(0, 0, 100, 0x8000000000000000ULL);
+    assert_test(acc_tail_floor.finalize_floor() == spas_fract168_t(0, 0, 1, 0xFFFFFFFFFFFFFFFFULL),
+                "Accumulator finalize_floor still rounds the same tail toward -inf");
+
+    // A negative term shifted out of lo entirely leaves the nearest accumulator alone and only lowers the floor one
+    spas_fract168_t deep(0, 0, 0, 1); // 2^-128 left unnormalized, so lo holds it in under 64 bits and finalize() rounds nothing
+    spas_accum168_t acc_deep(deep), acc_deep_floor(deep, SPAS_ACCUM_FLOOR);
+    acc_deep -= spas_fract168_t(0, 0, 200, 0x8000000000000000ULL);
+    acc_deep_floor -= spas_fract168_t(0, 0, 200, 0x8000000000000000ULL);
+    assert_test(same_value(acc_deep.finalize(), deep) &&
+                spas_accum168_t(acc_deep_floor.finalize_floor()) < spas_accum168_t(deep),
+                "Accumulator drops a fully shifted out term unless it floors");
+
+    // Intermediate values outside (-1.0, 1.0) are allowed as long as the final value fits
+    spas_accum168_t acc_guard;
+    acc_guard += spas_fract168_t(0.75);
+    acc_guard += spas_fract168_t(0.75);
+    acc_guard -= spas_fract168_t(0.75);
+    assert_test(approx_eq(acc_guard.getDouble(), 0.75), "Accumulator guard bits absorb intermediate overflow");
+
+    bool thrown = false;
+    try{ acc_guard += spas_fract168_t(0.75); acc_guard.finalize(); }
+    catch(const std::invalid_argument&){ thrown = true; }
+    assert_test(thrown, "Accumulator throws on finalize when the value is out of range");
+
+    spas_accum168_t tiny(spas_fract168_t(0, 0, 40, 0x8000000000000000ULL));
+    spas_accum168_t tinier(spas_fract168_t(0, 0, 41, 0x8000000000000000ULL));
+    assert_test(tinier < tiny && tiny > tinier && tiny != tinier, "Accumulator compares values living only in 'small'");
+    tinier += spas_fract168_t(0, 0, 41, 0x8000000000000000ULL);
+    assert_test(tinier == tiny, "Accumulator equality after realigning offsets");
+    assert_test(spas_accum168_t(spas_fract168_t(-0.5)) < tinier, "Accumulator compares across signs");
+
+    // 2^-64 - 2^-65 keeps 'big' and 'small' of opposite signs, shifting must not OR them together
+    spas_accum168_t mixed(spas_fract168_t(0, 1, 0, 0));
+    mixed -= spas_fract168_t(0, 0, 0, 0x8000000000000000ULL);
+    mixed <<= 1;
+    tiny <<= 3;
+    assert_test(same_value(mixed.finalize(), spas_fract168_t(0, 1, 0, 0)) && tiny.finalize() == spas_fract168_t(0, 0, 37, 0x8000000000000000ULL),
+                "Accumulator shift is exact across mixed signs and deep offsets");
+    // -2^-50 + 2^-100 shifted by 40 is -2^-10 + 2^-60, all in 'big'
+    spas_accum168_t carry_in(spas_fract168_t(0b1000, 1ULL << 14, 0, 0));
+    carry_in += spas_fract168_t(0, 0, 35, 0x8000000000000000ULL);
+    carry_in <<= 40;
+    assert_test(carry_in.finalize() == spas_fract168_t(0b1000, (1ULL << 54) - 16, 0, 0), "Accumulator shift moves 'small' bits into 'big'");
+    thrown = false;
+    try{ spas_accum168_t over(spas_fract168_t(0.75)); over <<= 1; over.finalize(); }
+    catch(const std::invalid_argument&){ thrown = true; }
+    assert_test(thrown, "Accumulator shift throws when the value leaves the range");
+}
+
+void test_dispatch_kernels() {
+    std::cout << "\n--- Testing Dispatched Kernels ---\n";
+
+    const size_t n = 37; // Leaves a tail after the 8 lane vector loop
+    std::vector<uint64_t> a(n), b(n);
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for(size_t i=0; i<n; i++){
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        a[i] = x;
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        b[i] = x;
+    }
+    a[0] = b[0] = 0xFFFFFFFFFFFFFFFFULL;
+
+    std::vector<uint64_t> ref_big(n), ref_small(n), big(n), small(n);
+    _fraction_multiply_batch_generic(a.data(), b.data(), ref_big.data(), ref_small.data(), n);
+    std::vector<unsigned char> sa(n), sb(n);
+    spas_soa168_t fa, fb;
+    for(size_t i=0; i<n; i++){
+        sa[i] = (a[i] & 1) ? 0b1000 : 0;
+        sb[i] = (b[i] & 2) ? 0b1000 : 0;
+        fa.push_back(spas_fract168_t(sa[i], a[i] >> 1, (uint32_t)i, (i%3) ? b[i] | 1 : 0));
+        fb.push_back(spas_fract168_t(sb[i], b[i] >> 1, (uint32_t)(i%5), (i%4 == 1) ? a[i] | 1 : 0));
+    }
+    uint64_t ref_pos[3] = {0, 0, 0}, ref_neg[3] = {0, 0, 0};
+    _fraction_dot_batch_signed_generic(a.data(), sa.data(), b.data(), sb.data(), n, ref_pos, ref_neg);
+    spas_accum168_t ref_mac;
+    for(size_t i=0; i<n; i++){
+        ref_mac.mac(fa.get(i), fb.get(i));
+    }
+
+    const spas_cpu_features_t native = spas_cpu_features();
+    spas_cpu_features_t levels[3] = {native, native, native};
+    levels[1].avx512ifma = false;
+    levels[2].bmi2 = levels[2].adx = levels[2].avx512ifma = false;
+    const char* names[3] = {"native", "MULX/ADX", "generic"};
+
+    for(int l=0; l<3; l++){
+        spas_cpu_set_features(levels[l]);
+        fraction_multiply_batch(a.data(), b.data(), big.data(), small.data(), n);
+        assert_test(big == ref_big && small == ref_small,
+                    std::string("Batch multiply matches fraction_multiply on ") + names[l] + " path");
+        uint64_t pos[3] = {0, 0, 0}, neg[3] = {0, 0, 0};
+        fraction_dot_batch_signed(a.data(), sa.data(), b.data(), sb.data(), n, pos, neg);
+        assert_test(std::equal(pos, pos+3, ref_pos) && std::equal(neg, neg+3, ref_neg) && ref_pos[2] && ref_neg[2],
+                    std::string("Signed batch dot product splits by sign on ") + names[l] + " path");
+        spas_accum168_t acc_batch;
+        acc_batch.mac_batch(fa, 0, fb, 0, n);
+        // Per pair mac and mac_batch round the shifted out bits in a different order, they may differ by a few 2^-160
+        spas_accum168_t slack_lo = ref_mac, slack_hi = ref_mac;
+        slack_lo -= spas_fract168_t(0b0000, 0, 16, 0x8000000000000000ULL);
+        slack_hi += spas_fract168_t(0b0000, 0, 16, 0x8000000000000000ULL);
+        assert_test(slack_lo <= acc_batch && acc_batch <= slack_hi,
+                    std::string("mac_batch matches per pair mac on ") + names[l] + " path");
+    }
+    spas_cpu_set_features(native);
+
+    uint64_t lhs = 0x8000000000000000ULL;
+    uint8_t carry = fraction_addition(lhs, 0x8000000000000000ULL, 0);
+    assert_test(carry == 1 && lhs == 0, "fraction_addition reports carry out");
+    carry = fraction_subtraction(lhs, 0x8000000000000000ULL, 63);
+    assert_test(carry == 1 && lhs == 0xFFFFFFFFFFFFFFFFULL, "fraction_subtraction reports borrow out");
+}
+
+void test_csr_spmv() {
+    std::cout << "\n--- Testing Sparse Matrix Vector Product ---\n";
+
+    spas_fract168_t a_plus_b(0b0000, 0x8000000000000000ULL, 0, 0x8000000000000000ULL); // 0.5 + 2^-65
+    spas_accum168_t acc_mac;
+    acc_mac.mac(a_plus_b, spas_fract168_t(0.5));
+    assert_test(acc_mac.finalize() == a_plus_b*spas_fract168_t(0.5), "Accumulator multiply-accumulate matches operator*");
+    acc_mac.mac(spas_fract168_t(-0.5), spas_fract168_t(0.5));
+    assert_test(acc_mac.finalize() == spas_fract168_t(0, 0, 1, 0x8000000000000000ULL), "Accumulator multiply-accumulate cancels 'big' terms");
+
+    // 4x3 matrix, row 2 is empty and (3,1) is given twice
+    std::vector<uint32_t> row = {0, 0, 1, 1, 3, 3, 3};
+    std::vector<uint32_t> col = {0, 2, 1, 2, 0, 1, 1};
+    spas_soa168_t val;
+    val.push_back(spas_fract168_t(0.5));
+    val.push_back(spas_fract168_t(-0.125));
+    val.push_back(a_plus_b);
+    val.push_back(spas_fract168_t(0.375));
+    val.push_back(spas_fract168_t(0.25));
+    val.push_back(spas_fract168_t(0.125));
+    val.push_back(spas_fract168_t(0.125));
+    spas_csr168_t A(4, 3, row, col, val);
+    assert_test(A.nnz() == 7 && A.row_ptr[2] == A.row_ptr[3], "CSR construction from triplets");
+
+    spas_soa168_t x;
+    x.push_back(spas_fract168_t(0.5));
+    x.push_back(spas_fract168_t(-0.25));
+    x.push_back(spas_fract168_t(0.125));
+
+    spas_soa168_t y;
+    spas_csr_spmv(A, x, y, 1);
+    spas_fract168_t y0 = spas_fract168_t(0.5)*x.get(0) + spas_fract168_t(-0.125)*x.get(2);
+    spas_fract168_t y1 = a_plus_b*x.get(1) + spas_fract168_t(0.375)*x.get(2);
+    spas_fract168_t y3 = spas_fract168_t(0.25)*x.get(0) + spas_fract168_t(0.25)*x.get(1);
+    assert_test(y.size() == 4 && y.get(0) == y0 && y.get(1) == y1 && y.get(2) == spas_fract168_t() && y.get(3) == y3,
+                "SpMV matches operator* and operator+ row by row");
+
+    spas_soa168_t y_mt;
+    spas_csr_spmv(A, x, y_mt, 3);
+    bool same = true;
+    for(size_t i=0; i<y.size(); i++){ same = same && y_mt.get(i) == y.get(i); }
+    assert_test(same, "Multithreaded SpMV matches single thread");
+
+    // A^T*z against the SpMV of the explicitly transposed matrix
+    spas_csr168_t At(3, 4, col, row, val);
+    spas_soa168_t z;
+    z.push_back(spas_fract168_t(0.25));
+    z.push_back(spas_fract168_t(-0.5));
+    z.push_back(spas_fract168_t(0.75));
+    z.push_back(spas_fract168_t(0.5));
+    spas_soa168_t yt, yt_ref, yt_mt, yt_idle;
+    spas_csr_spmv(At, z, yt_ref, 1);
+    spas_csr_spmv_transposed(A, z, yt, 1);
+    spas_csr_spmv_transposed(A, z, yt_mt, 3);
+    spas_csr_spmv_transposed(A, z, yt_idle, 8); // More threads than rows, some own no columns at all
+    same = yt.size() == 3 && yt_idle.size() == 3;
+    for(size_t i=0; same && i<yt.size(); i++){ same = yt.get(i) == yt_ref.get(i) && yt_mt.get(i) == yt_ref.get(i) && yt_idle.get(i) == yt_ref.get(i); }
+    assert_test(same, "Transposed SpMV matches SpMV of the transpose, single and multithreaded");
+
+    // A plan is built once and reused, the second call must not depend on state left by the first
+    spas_csr_transpose_plan_t plan(A, 3);
+    spas_soa168_t yt_plan;
+    spas_csr_spmv_transposed(A, z, yt_plan, plan);
+    spas_csr_spmv_transposed(A, z, yt_plan, plan);
+    same = yt_plan.size() == 3;
+    for(size_t i=0; same && i<yt_plan.size(); i++){ same = yt_plan.get(i) == yt_ref.get(i); }
+    bool rejected = false;
+    try{ spas_csr_spmv_transposed(At, x, yt_plan, plan); }catch(const std::invalid_argument&){ rejected = true; }
+    assert_test(same && rejected, "Transposed SpMV reuses a plan and rejects one built for another matrix");
+}
+
+void test_filters() {
+    std::cout << "\n--- Testing Filters and Convolution ---\n";
+
+    spas_fract168_t a_minus_b(0b0001, 0x8000000000000000ULL, 0, 0x8000000000000000ULL); // 0.5 - 2^-65
+    spas_soa168_t taps;
+    taps.push_back(spas_fract168_t(0.25));
+    taps.push_back(a_minus_b);
+    taps.push_back(spas_fract168_t(-0.125));
+
+    spas_soa168_t impulse(5);
+    impulse.set(0, spas_fract168_t(0.5));
+    spas_fir168_t fir(taps);
+    spas_soa168_t out;
+    fir.process(impulse, out);
+    assert_test(same_value(out.get(0), taps.get(0)*spas_fract168_t(0.5)) && same_value(out.get(1), taps.get(1)*spas_fract168_t(0.5)) &&
+                same_value(out.get(2), taps.get(2)*spas_fract168_t(0.5)) && out.get(3) == spas_fract168_t(),
+                "FIR impulse response reproduces the taps");
+
+    spas_soa168_t x;
+    x.push_back(spas_fract168_t(0.5));
+    x.push_back(spas_fract168_t(-0.25));
+    x.push_back(spas_fract168_t(0, 0, 3, 0xC000000000000000ULL));
+    x.push_back(spas_fract168_t(0.375));
+    x.push_back(spas_fract168_t(-0.5));
+
+    spas_soa168_t conv, conv_mt;
+    spas_convolve(x, taps, conv, 1);
+    spas_convolve(x, taps, conv_mt, 3);
+    assert_test(conv.size() == 7, "Convolution has length x+h-1");
+
+    // Feed the FIR in two uneven blocks, history has to carry over
+    spas_fir168_t fir_blocks(taps);
+    spas_soa168_t first(2), second(3), out_first, out_second;
+    for(size_t i=0; i<2; i++){ first.set(i, x.get(i)); }
+    for(size_t i=0; i<3; i++){ second.set(i, x.get(i+2)); }
+    fir_blocks.process(first, out_first);
+    fir_blocks.process(second, out_second);
+    bool same = true;
+    for(size_t i=0; i<5; i++){
+        spas_fract168_t y = (i < 2) ? out_first.get(i) : out_second.get(i-2);
+        same = same && y == conv.get(i) && conv_mt.get(i) == conv.get(i);
+    }
+    assert_test(same, "Block FIR matches convolution, single and multithreaded");
+
+    // y[n] = 0.5*x[n] + y[n-1] - 0.25*y[n-2], coefficients stored divided by 2
+    spas_soa168_t coefficients;
+    coefficients.push_back(spas_fract168_t(0.25));
+    coefficients.push_back(spas_fract168_t(0.0));
+    coefficients.push_back(spas_fract168_t(0.0));
+    coefficients.push_back(spas_fract168_t(-0.5));
+    coefficients.push_back(spas_fract168_t(0.125));
+    spas_iir168_t iir(coefficients, 1);
+    spas_soa168_t unit(4);
+    unit.set(0, spas_fract168_t(0.5));
+    iir.process(unit, out);
+    assert_test(approx_eq(out.get(0).getDouble(), 0.25) && approx_eq(out.get(1).getDouble(), 0.25) &&
+                approx_eq(out.get(2).getDouble(), 0.1875) && approx_eq(out.get(3).getDouble(), 0.125),
+                "Biquad with scaled coefficients follows its difference equation");
+
+    // Two cascaded first order sections, y[n] = 0.5*x[n] + 0.5*y[n-1] each
+    spas_soa168_t cascade;
+    for(int s=0; s<2; s++){
+        cascade.push_back(spas_fract168_t(0.5));
+        cascade.push_back(spas_fract168_t(0.0));
+        cascade.push_back(spas_fract168_t(0.0));
+        cascade.push_back(spas_fract168_t(-0.5));
+        cascade.push_back(spas_fract168_t(0.0));
+    }
+    spas_iir168_t iir_cascade(cascade, 0);
+    iir_cascade.process(unit, out);
+    assert_test(approx_eq(out.get(0).getDouble(), 0.125) && approx_eq(out.get(1).getDouble(), 0.125) &&
+                approx_eq(out.get(2).getDouble(), 0.09375), "Biquad cascade feeds each section into the next");
+
+    // y[n] = x[n] - 1.5*x[n-1] stored as (0.5, -0.75) << 1, on 2^-63 after about 2^-64 the section sum is
+    // 2^-64 - 0.75*(2^-64 - 2^-128), 'big' and 'small' of opposite signs with 'small' at offset 0
+    spas_soa168_t diff(5);
+    diff.set(0, spas_fract168_t(0.5));
+    diff.set(1, spas_fract168_t(-0.75));
+    spas_iir168_t iir_diff(diff, 1);
+    spas_soa168_t steps;
+    steps.push_back(spas_fract168_t(0, 0, 0, 0xFFFFFFFFFFFFFFFFULL));
+    steps.push_back(spas_fract168_t(0, 2, 0, 0));
+    iir_diff.process(steps, out);
+    spas_fract168_t expected(0, 0, 0, 0x8000000000000002ULL); // 2^-65 + 1.5*2^-128, the tie rounds to even
+    assert_test(same_value(out.get(0), steps.get(0)) && same_value(out.get(1), expected),
+                "Biquad output scaling is exact across mixed signs");
+
+    // y[n] = 0.9*x[n] + 0.9*y[n-1] on a constant 0.9 reaches 1.539 on the second sample
+    spas_soa168_t runaway;
+    runaway.push_back(spas_fract168_t(0.45));
+    runaway.push_back(spas_fract168_t(0.0));
+    runaway.push_back(spas_fract168_t(0.0));
+    runaway.push_back(spas_fract168_t(-0.45));
+    runaway.push_back(spas_fract168_t(0.0));
+    spas_iir168_t iir_runaway(runaway, 1);
+    spas_soa168_t constant(3);
+    for(size_t i=0; i<3; i++){ constant.set(i, spas_fract168_t(0.9)); }
+    bool thrown = false;
+    try{ iir_runaway.process(constant, out); }
+    catch(const std::invalid_argument&){ thrown = true; }
+    assert_test(thrown, "Biquad throws when a section output leaves the range");
+}
+
+void test_qformat() {
+    std::cout << "\n--- Testing Q-format Import/Export ---\n";
+
+    int32_t q31[3] = {0x40000000, -0x20000000, 1};
+    spas_soa168_t f31;
+    spas_from_q31(q31, 3, f31);
+    assert_test(f31.get(0) == spas_fract168_t(0.5) && f31.get(1) == spas_fract168_t(-0.25) &&
+                f31.get(2) == spas_fract168_t(0, 0x0000000200000000ULL, 0, 0), "Q31 import is exact");
+
+    // Odd Q63 words need all 63 bits, which a double can't hold
+    std::vector<int64_t> q63 = {0x7FFFFFFFFFFFFFFFLL, -0x5555555555555555LL, 0, INT64_MIN, 3, -1, 12345, -99999};
+    for(int i=0; i<9; i++){ q63.push_back((int64_t)(0x9E3779B97F4A7C15ULL*(i+1))); }
+    spas_soa168_t f63;
+    spas_from_q63(q63.data(), q63.size(), f63);
+    assert_test(f63.get(0) == spas_fract168_t(0, 0xFFFFFFFFFFFFFFFEULL, 0, 0), "Q63 import keeps every bit");
+    assert_test(f63.get(3) == spas_fract168_t(0b1001, 0xFFFFFFFFFFFFFFFFULL, 0, 0xFFFFFFFFFFFFFFFFULL),
+                "Q63 import saturates INT_MIN to the closest fraction");
+
+    std::vector<int64_t> back(q63.size());
+    assert_test(spas_to_q63(f63, back.data()) == 0 && back == q63, "Q63 round trip is lossless, including INT_MIN");
+
+    const spas_cpu_features_t native = spas_cpu_features();
+    spas_cpu_features_t generic = native;
+    generic.avx2 = false;
+    spas_cpu_set_features(generic);
+    spas_soa168_t f63_generic;
+    spas_from_q63(q63.data(), q63.size(), f63_generic);
+    spas_cpu_set_features(native);
+    bool same = true;
+    for(size_t i=0; i<q63.size(); i++){ same = same && f63.get(i) == f63_generic.get(i); }
+    assert_test(same, "Vector and generic Q63 import agree");
+
+    int16_t q15[4] = {INT16_MIN, -1, 0, INT16_MAX};
+    spas_fract168_t f15[4];
+    int16_t q15_back[4];
+    spas_from_q15(q15, 4, f15);
+    spas_to_q15(f15, 4, q15_back);
+    assert_test(memcmp(q15, q15_back, sizeof(q15)) == 0, "Q15 round trip through an array of fractions");
+
+    // 2.5 and 3.5 Q15 units, optionally nudged by a 'small' portion
+    spas_fract168_t two_half(0, (5ULL<<48), 0, 0);
+    spas_fract168_t three_half(0, (7ULL<<48), 0, 0);
+    spas_fract168_t two_half_up(0b0000, (5ULL<<48), 20, 0x8000000000000000ULL);
+    spas_fract168_t two_half_down(0b0001, (5ULL<<48), 20, 0x8000000000000000ULL);
+    spas_fract168_t rounding[6] = {two_half, three_half, two_half_up, two_half_down, -two_half, -two_half_down};
+    int16_t q[6];
+    spas_to_q15(rounding, 6, q, SPAS_ROUND_NEAREST_EVEN);
+    assert_test(q[0] == 2 && q[1] == 4 && q[2] == 3 && q[3] == 2 && q[4] == -2 && q[5] == -2,
+                "Q15 export rounds to nearest even and breaks ties with the 'small' portion");
+    spas_to_q15(rounding, 6, q, SPAS_ROUND_NEAREST_AWAY);
+    assert_test(q[0] == 3 && q[1] == 4 && q[3] == 2 && q[4] == -3, "Q15 export rounds ties away from zero");
+    spas_to_q15(rounding, 6, q, SPAS_ROUND_TRUNCATE);
+    assert_test(q[0] == 2 && q[4] == -2 && q[5] == -2, "Q15 export truncates toward zero");
+    spas_to_q15(rounding, 6, q, SPAS_ROUND_FLOOR);
+    assert_test(q[0] == 2 && q[4] == -3 && q[5] == -3, "Q15 export rounds toward negative infinity");
+    spas_to_q15(rounding, 6, q, SPAS_ROUND_CEIL);
+    assert_test(q[0] == 3 && q[3] == 3 && q[4] == -2, "Q15 export rounds toward positive infinity");
+
+    // Exactly 2 units minus a 'small' portion truncates to 1
+    spas_fract168_t below_two(0b0001, (2ULL<<49), 0, 1);
+    spas_to_q15(&below_two, 1, q, SPAS_ROUND_TRUNCATE);
+    assert_test(q[0] == 1, "Q15 export borrows from 'big' for a negative 'small' portion");
+
+    spas_fract168_t almost_one(0, 0xFFFFFFFFFFFFFFFFULL, 0, 0);
+    size_t clipped = spas_to_q15(&almost_one, 1, q, SPAS_ROUND_NEAREST_EVEN, true);
+    assert_test(clipped == 1 && q[0] == INT16_MAX, "Q15 export saturates values rounding up to 1.0");
+    clipped = spas_to_q15(&almost_one, 1, q, SPAS_ROUND_NEAREST_EVEN, false);
+    assert_test(clipped == 1 && q[0] == INT16_MIN, "Q15 export wraps around without saturation");
+}
+
+void test_random() {
+    std::cout << "\n--- Testing Bulk Random Generator ---\n";
+
+    // Lane 0 has to follow the reference xoshiro256** recurrence
+    spas_rng168_t rng(42);
+    uint64_t ref[4] = {rng.s[0][0], rng.s[1][0], rng.s[2][0], rng.s[3][0]};
+    std::vector<uint64_t> w(4*16);
+    rng.words(w.data(), w.size());
+    bool same = true;
+    for(size_t i=0; i<16; i++){
+        uint64_t r = ((ref[1]*5 << 7) | (ref[1]*5 >> 57))*9;
+        uint64_t t = ref[1] << 17;
+        ref[2] ^= ref[0]; ref[3] ^= ref[1]; ref[1] ^= ref[2]; ref[0] ^= ref[3]; ref[2] ^= t;
+        ref[3] = (ref[3] << 45) | (ref[3] >> 19);
+        same = same && w[4*i] == r;
+    }
+    assert_test(same, "Generator lanes follow the xoshiro256** recurrence");
+
+    const spas_cpu_features_t native = spas_cpu_features();
+    spas_cpu_features_t generic = native;
+    generic.avx2 = false;
+    spas_rng168_t rng_a(7), rng_b(7);
+    spas_soa168_t u, u_generic;
+    rng_a.uniform(u, 1001, true);
+    spas_cpu_set_features(generic);
+    rng_b.uniform(u_generic, 1001, true);
+    spas_cpu_set_features(native);
+    same = true;
+    for(size_t i=0; i<u.size(); i++){ same = same && u.get(i) == u_generic.get(i); }
+    assert_test(same, "Vector and generic generator paths produce the same samples");
+
+    const size_t n = 1 << 14;
+    spas_rng168_t rng_u(2024);
+    rng_u.uniform(u, n);
+    size_t normalized = 0, offset0 = 0, offset1 = 0;
+    double mean = 0;
+    for(size_t i=0; i<n; i++){
+        normalized += (u.small[i] >> 63) && u.sign[i] == 0;
+        offset0 += u.offset[i] == 0;
+        offset1 += u.offset[i] == 1;
+        mean += u.get(i).getDouble();
+    }
+    mean /= n;
+    assert_test(normalized == n, "Uniform samples are positive with a normalized 'small'");
+    assert_test(std::abs(mean - 0.5) < 0.01, "Uniform samples average to 0.5");
+    assert_test(std::abs((double)offset0/n - 0.5) < 0.02 && std::abs((double)offset1/n - 0.25) < 0.02,
+                "Offsets of 'small' follow the geometric distribution of leading zeros");
+
+    rng_u.uniform(u, n, true);
+    size_t negative = 0;
+    for(size_t i=0; i<n; i++){ negative += u.get(i).getDouble() < 0; }
+    assert_test(std::abs((double)negative/n - 0.5) < 0.02, "Signed samples are negative half of the time");
+
+    spas_rng168_t parent(99);
+    spas_rng168_t first = parent.split();
+    spas_rng168_t second = parent.split();
+    spas_rng168_t fresh(99);
+    uint64_t a[8], b[8], c[8];
+    first.words(a, 8);
+    second.words(b, 8);
+    fresh.words(c, 8);
+    assert_test(memcmp(a, c, sizeof(a)) == 0 && memcmp(a, b, sizeof(a)) != 0, "Split streams start where the parent was and differ from each other");
+}
+
+void test_interval() {
+    std::cout << "\n--- Testing Interval Arithmetic ---\n";
+
+    // Exact operations give point results
+    spas_fract168_t a_plus_b(0b0000, 0x8000000000000000ULL, 0, 0x8000000000000000ULL); // 0.5 + 2^-65
+    assert_test(add_down(a_plus_b, spas_fract168_t(0.25)) == add_up(a_plus_b, spas_fract168_t(0.25)) &&
+                same_value(mul_down(a_plus_b, spas_fract168_t(-0.5)), a_plus_b*spas_fract168_t(-0.5)) &&
+                same_value(mul_up(a_plus_b, spas_fract168_t(-0.5)), a_plus_b*spas_fract168_t(-0.5)),
+                "Directed rounding is exact when nothing is discarded");
+
+    // 2^-65 + 2^-(65+200)*(1+...) drops the second 'small' entirely
+    spas_fract168_t coarse(0, 0, 0, 0x8000000000000000ULL);
+    spas_fract168_t fine(0, 0, 200, 0xFFFFFFFFFFFFFFFFULL);
+    spas_fract168_t down = add_down(coarse, fine), up = add_up(coarse, fine);
+    assert_test(down == coarse && spas_accum168_t(coarse) < spas_accum168_t(up), "Addition rounds down and up around discarded bits");
+    down = sub_down(coarse, fine);
+    up = sub_up(coarse, fine);
+    assert_test(spas_accum168_t(down) < spas_accum168_t(coarse) && same_value(up, coarse), "Subtraction rounds down and up around discarded bits");
+
+    // Deep tails in both operands, the product cross terms get truncated
+    spas_fract168_t x(0b0001, 0xAAAAAAAAAAAAAAABULL, 3, 0xF0F0F0F0F0F0F0F1ULL);
+    spas_fract168_t y(0b1000, 0x3333333333333333ULL, 70, 0x8000000000000001ULL);
+    spas_accum168_t point;
+    point.mac(x, y);
+    spas_fract168_t md = mul_down(x, y), mu = mul_up(x, y);
+    assert_test(spas_accum168_t(md) <= point && spas_accum168_t(mu) >= spas_accum168_t(point.finalize()) &&
+                spas_accum168_t(md) < spas_accum168_t(mu), "Multiplication bounds enclose the product");
+
+    spas_interval168_t ia(spas_fract168_t(-0.25), spas_fract168_t(0.5));
+    spas_interval168_t ib(spas_fract168_t(-0.75), spas_fract168_t(0.5));
+    spas_interval168_t ip = ia*ib;
+    assert_test(approx_eq(ip.lower.getDouble(), -0.375) && approx_eq(ip.upper.getDouble(), 0.25),
+                "Interval product of two intervals straddling zero");
+    spas_interval168_t is = ia - spas_interval168_t(spas_fract168_t(-0.25), spas_fract168_t(0.125));
+    assert_test(approx_eq(is.lower.getDouble(), -0.375) && approx_eq(is.upper.getDouble(), 0.75) &&
+                is.contains(spas_fract168_t(0.0)), "Interval subtraction pairs opposite bounds");
+
+    bool thrown = false;
+    try{ spas_interval168_t bad(spas_fract168_t(0.5), spas_fract168_t(0.25)); }
+    catch(const std::invalid_argument&){ thrown = true; }
+    assert_test(thrown, "Interval constructor rejects lower > upper");
+
+    // Batch kernels agree with the scalar operators across every sign case
+    const double bounds[5][2] = {{0.125, 0.375}, {-0.375, -0.125}, {-0.25, 0.375}, {0.0, 0.25}, {-0.375, 0.0}};
+    spas_interval_soa168_t va, vb, vr;
+    for(int i=0; i<5; i++){
+        for(int j=0; j<5; j++){
+            spas_interval168_t p(spas_fract168_t(bounds[i][0]), spas_fract168_t(bounds[i][1]));
+            spas_interval168_t q(spas_fract168_t(bounds[j][0]), spas_fract168_t(bounds[j][1]));
+            p.upper = p.upper + x*spas_fract168_t(0.0625); // Let the tails of x take part
+            va.resize(va.size()+1);
+            vb.resize(vb.size()+1);
+            va.set(va.size()-1, p);
+            vb.set(vb.size()-1, q);
+        }
+    }
+    bool same = true, enclosed = true;
+    spas_interval_mul_batch(va, vb, vr);
+    for(size_t i=0; i<va.size(); i++){
+        spas_interval168_t r = va.get(i)*vb.get(i);
+        same = same && r.lower == vr.lower.get(i) && r.upper == vr.upper.get(i);
+        // Every corner product lies within the result
+        spas_fract168_t corners[4] = {va.lower.get(i), va.upper.get(i), vb.lower.get(i), vb.upper.get(i)};
+        for(int c=0; c<4; c++){
+            spas_accum168_t acc;
+            acc.mac(corners[c/2], corners[2+c%2]);
+            enclosed = enclosed && spas_accum168_t(r.lower) <= acc && acc.finalize_floor() <= r.upper;
+        }
+    }
+    assert_test(same, "Interval multiply batch matches operator*");
+    assert_test(enclosed, "Interval multiply encloses every corner product");
+
+    spas_interval_add_batch(va, vb, vr);
+    same = true;
+    for(size_t i=0; i<va.size(); i++){
+        spas_interval168_t r = va.get(i) + vb.get(i);
+        same = same && r.lower == vr.lower.get(i) && r.upper == vr.upper.get(i);
+    }
+    spas_interval_sub_batch(va, vb, vr);
+    for(size_t i=0; i<va.size(); i++){
+        spas_interval168_t r = va.get(i) - vb.get(i);
+        same = same && r.lower == vr.lower.get(i) && r.upper == vr.upper.get(i);
+    }
+    assert_test(same, "Interval add and sub batches match the operators");
+}
+
+void test_polynomial() {
+    std::cout << "\n--- Testing Polynomial Evaluation ---\n";
+
+    // p(x) = 0.25 + 0.5x - 0.125x^2 + 0.0625x^3 + 0.03125x^4
+    spas_soa168_t c;
+    c.push_back(spas_fract168_t(0.25));
+    c.push_back(spas_fract168_t(0.5));
+    c.push_back(spas_fract168_t(-0.125));
+    c.push_back(spas_fract168_t(0.0625));
+    c.push_back(spas_fract168_t(0.03125));
+    spas_poly168_t p(c);
+    assert_test(p.degree() == 4, "Polynomial degree follows the coefficient count");
+
+    spas_fract168_t x(0.5);
+    spas_fract168_t x2 = x*x;
+    spas_fract168_t ref = c.get(0) + c.get(1)*x + c.get(2)*x2 + c.get(3)*x2*x + c.get(4)*x2*x2;
+    assert_test(same_value(p.evaluate(x), ref) && same_value(p.evaluate(x, SPAS_POLY_ESTRIN), ref),
+                "Horner and Estrin match the expanded polynomial");
+
+    // 11 inputs leave a partial interleaved block, some carry a 'small' portion
+    spas_soa168_t xs;
+    for(int i=0; i<11; i++){
+        xs.push_back(spas_fract168_t(0b0000, (uint64_t)(i*0x1745D1745D1745D1ULL) >> 1, (uint32_t)i, (i%3) ? 0x8000000000000001ULL : 0));
+    }
+    xs.set(5, -xs.get(5));
+    spas_soa168_t yh, ye, yh_mt;
+    p.evaluate(xs, yh, SPAS_POLY_HORNER, 1);
+    p.evaluate(xs, ye, SPAS_POLY_ESTRIN, 1);
+    p.evaluate(xs, yh_mt, SPAS_POLY_HORNER, 3);
+    bool same = yh.size() == 11, close = true;
+    for(size_t i=0; i<xs.size(); i++){
+        same = same && yh.get(i) == yh_mt.get(i) && yh.get(i) == p.evaluate(xs.get(i));
+        double xd = xs.get(i).getDouble();
+        double pd = 0.25 + xd*(0.5 + xd*(-0.125 + xd*(0.0625 + xd*0.03125)));
+        close = close && approx_eq(yh.get(i).getDouble(), pd) && approx_eq(ye.get(i).getDouble(), pd);
+    }
+    assert_test(same, "Batch Horner matches single point evaluation, single and multithreaded");
+    assert_test(close, "Batch Horner and Estrin agree with double evaluation");
+
+    spas_soa168_t constant(1);
+    constant.set(0, spas_fract168_t(-0.75));
+    spas_poly168_t q(constant);
+    assert_test(same_value(q.evaluate(x), spas_fract168_t(-0.75)) && same_value(q.evaluate(x, SPAS_POLY_ESTRIN), spas_fract168_t(-0.75)),
+                "Degree 0 polynomial is its constant");
+}
+
+#ifdef SPAS_DAEMON
+// Connect to a freshly forked daemon, retrying until it listens
+static spas_client_t* connect_daemon(const std::string& path) {
+    for (int attempt = 0; ; attempt++) {
+        try {
+            return new spas_client_t(path);
+        } catch (const std::runtime_error&) {
+            if (attempt == 200) throw;
+            usleep(10000);
+        }
+    }
+}
+
+void test_daemon() {
+    std::cout << "\n--- Testing Batch Daemon ---\n";
+
+    std::string path = "/tmp/spas_test_" + std::to_string(getpid()) + ".sock";
+    pid_t server = fork();
+    if (server == 0) {
+        spas_server_run(path, 2);
+        _exit(0);
+    }
+    spas_client_t* client = connect_daemon(path);
+
+    spas_soa168_t c;
+    c.push_back(spas_fract168_t(0.25));
+    c.push_back(spas_fract168_t(-0.5));
+    c.push_back(spas_fract168_t(0.125));
+    spas_poly168_t p(c);
+
+    spas_soa168_t xs, m;
+    for (int i = 0; i < 9; i++) {
+        xs.push_back(spas_fract168_t(0b0000, (uint64_t)(i*0x1745D1745D1745D1ULL) >> 4, (uint32_t)i, (i%2) ? 0x8000000000000001ULL : 0));
+    }
+    xs.set(4, -xs.get(4));
+    for (int i = 0; i < 3*9; i++) {
+        m.push_back(spas_fract168_t(((i*7)%11 - 5)/64.0));
+    }
+
+    // Coefficients, matrix and inputs share one buffer, outputs follow them
+    size_t at_c = 0, at_m = spas_shm_soa_bytes(3), at_x = at_m + spas_shm_soa_bytes(27), at_y = at_x + spas_shm_soa_bytes(9);
+    uint32_t buffer = client->create_buffer(at_y + spas_shm_soa_bytes(9));
+    client->write_soa(buffer, at_c, c);
+    client->write_soa(buffer, at_m, m);
+    client->write_soa(buffer, at_x, xs);
+    uint32_t poly = client->load_poly(buffer, at_c, 3);
+    uint32_t matrix = client->load_matrix(buffer, at_m, 3, 9);
+
+    spas_soa168_t ys, ref;
+    client->poly(poly, SPAS_POLY_ESTRIN, buffer, at_x, 9, at_y);
+    client->read_soa(buffer, at_y, 9, ys);
+    p.evaluate(xs, ref, SPAS_POLY_ESTRIN, 1);
+    bool same = ys.size() == 9;
+    for (size_t i = 0; i < ref.size() && same; i++) {
+        same = ys.get(i) == ref.get(i);
+    }
+    assert_test(same, "Daemon polynomial job matches in-process evaluation");
+
+    client->reduce(buffer, at_x, 9, at_y);
+    client->read_soa(buffer, at_y, 1, ys);
+    spas_accum168_t sum;
+    for (size_t i = 0; i < xs.size(); i++) sum += xs.get(i);
+    assert_test(ys.get(0) == sum.finalize(), "Daemon reduce job matches the accumulator sum");
+
+    client->gemv(matrix, buffer, at_x, at_y);
+    client->read_soa(buffer, at_y, 3, ys);
+    same = true;
+    for (size_t r = 0; r < 3; r++) {
+        spas_accum168_t acc;
+        acc.mac_batch(m, r*9, xs, 0, 9);
+        same = same && ys.get(r) == acc.finalize();
+    }
+    assert_test(same, "Daemon gemv job matches the accumulated row products");
+
+    bool rejected = false;
+    try {
+        client->reduce(buffer, at_y, 9, at_y + spas_shm_soa_bytes(9));
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert_test(rejected, "Daemon rejects a payload out of the buffer bounds");
+
+    rejected = false;
+    try {
+        client->poly(matrix, SPAS_POLY_HORNER, buffer, at_x, 9, at_y);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert_test(rejected, "Daemon rejects a polynomial job on a matrix table");
+
+    rejected = false;
+    try {
+        client->load_matrix(buffer, at_m, (size_t)1 << 32, (size_t)1 << 32); // rows*cols wraps to 0 in 64 bits
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert_test(rejected, "Daemon rejects a matrix shape whose size overflows");
+
+    // Jobs run in place on the shared memory, the output may be the input itself but no other overlap
+    client->write_soa(buffer, at_y, xs);
+    client->poly(poly, SPAS_POLY_ESTRIN, buffer, at_y, 9, at_y);
+    client->read_soa(buffer, at_y, 9, ys);
+    same = ys.size() == 9;
+    for (size_t i = 0; i < ref.size() && same; i++) {
+        same = ys.get(i) == ref.get(i);
+    }
+    assert_test(same, "Daemon polynomial job evaluates in place");
+
+    int refused = 0;
+    try { client->poly(poly, SPAS_POLY_HORNER, buffer, at_x, 9, at_x + 8); } catch (const std::runtime_error&) { refused++; }
+    try { client->gemv(matrix, buffer, at_x, at_x); } catch (const std::runtime_error&) { refused++; }
+    try { client->reduce(buffer, at_x + 4, 1, at_y); } catch (const std::runtime_error&) { refused++; }
+    assert_test(refused == 3, "Daemon rejects overlapping and misaligned payloads");
+
+    // Far more responses than the socket holds pile up while the client is not reading
+    std::vector<uint32_t> ids;
+    for (int i = 0; i < 20000; i++) {
+        spas_request_t q = spas_request_t();
+        q.job = SPAS_JOB_REDUCE;
+        q.buffer = buffer;
+        q.n = 9;
+        q.in = at_x;
+        q.out = at_y;
+        ids.push_back(client->submit(q));
+    }
+    usleep(1500000);
+    bool all_ok = true;
+    for (size_t i = 0; i < ids.size(); i++) {
+        spas_response_t r = client->wait(ids[i]);
+        all_ok = all_ok && r.id == ids[i] && r.status == SPAS_STATUS_OK;
+    }
+    client->read_soa(buffer, at_y, 1, ys);
+    assert_test(all_ok && ys.get(0) == sum.finalize(), "Daemon answers every job of a deep pipeline read late");
+
+    delete client;
+    kill(server, SIGTERM);
+    int status = -1;
+    waitpid(server, &status, 0);
+    assert_test(WIFEXITED(status) && WEXITSTATUS(status) == 0, "Daemon shuts down cleanly on SIGTERM");
+}
+#endif
+
 int main() {
     std::cout << "Starting spas_fract168_t Testing Suite...\n";
 
@@ -194,6 +944,17 @@ int main() {
     test_shift_left();
     test_small_offset_operations();
     test_big_small_cross_interactions(); // NEW: Interactions between variables
+    test_accumulator();
+    test_dispatch_kernels();
+    test_csr_spmv();
+    test_filters();
+    test_qformat();
+    test_random();
+    test_interval();
+    test_polynomial();
+#ifdef SPAS_DAEMON
+    test_daemon();
+#endif
 
     std::cout << "\n--- Test Summary ---\n";
     std::cout << "Total Tests Run: " << tests_run << "\n";
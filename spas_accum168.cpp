@@ -0,0 +1,338 @@
+#include "spas_accum168.hpp"
+#include "spas_kernel168.hpp"
+
+// Return true if v is about to run out of guard bits in lo
+static inline bool lo_overflowing(__int128_t v){
+    __int128_t t = v >> 124;
+    return t != 0 && t != -1;
+}
+
+// Constructors
+spas_accum168_t::spas_accum168_t(){
+    this->mode = SPAS_ACCUM_NEAREST;
+    this->reset();
+}
+
+spas_accum168_t::spas_accum168_t(spas_accum_mode_t mode){
+    this->mode = mode;
+    this->reset();
+}
+
+spas_accum168_t::spas_accum168_t(const spas_fract168_t& t, spas_accum_mode_t mode){
+    this->mode = mode;
+    this->reset();
+    *this += t;
+}
+
+void spas_accum168_t::reset(){
+    this->hi = 0;
+    this->lo = 0;
+    this->anchor = 0;
+}
+
+// Return v / 2^d rounded as set by mode, |v| < 2^125 so adding half a unit never overflows
+__int128_t spas_accum168_t::shift_out(__int128_t v, uint64_t d){
+    if(this->mode == SPAS_ACCUM_FLOOR){
+        if(d >= 127){return v < 0 ? -1 : 0;}
+        return v >> d;
+    }
+    if(d >= 126){return 0;}
+    if(d == 0){return v;}
+    return (v + ((__int128_t)1 << (d - 1))) >> d; // Ties go up, which only decides values already below the guard bits
+}
+
+// Add v / 2^(160+offset) into lo, realigning the anchor only if v is larger than anything seen so far
+void spas_accum168_t::add_wide(__int128_t v, uint64_t offset){
+    if(!v){return;}
+    if(this->lo == 0){
+        this->lo = v;
+        this->anchor = offset;
+    }
+    else{
+        if(offset < this->anchor){
+            uint64_t d = this->anchor - offset;
+            this->lo = this->shift_out(this->lo, d);
+            this->anchor = offset;
+        }
+        uint64_t d = offset - this->anchor;
+        this->lo += this->shift_out(v, d);
+    }
+    if(lo_overflowing(this->lo)){
+        this->spill();
+    }
+}
+
+void spas_accum168_t::add_small(unsigned char neg, uint64_t small, uint64_t offset){
+    if(!small){return;}
+    __int128_t v = (__int128_t)((__uint128_t)small << 32);
+    this->add_wide(neg ? -v : v, offset);
+}
+
+// (sa*A + ta*a) * (sb*B + tb*b) = sa*sb*A*B + sa*tb*A*b + ta*sb*a*B + ta*tb*a*b
+void spas_accum168_t::mac(const spas_fract168_t& a, const spas_fract168_t& b){
+    if(a.big && b.big){ // big*big / 2^128, the lower half lands exactly on small with offset 0
+        uint64_t big, small;
+        unsigned char neg = ((a.sign^b.sign)>>3)&1;
+        fraction_multiply(a.big, b.big, big, small);
+        this->hi += neg ? -(__int128_t)big : (__int128_t)big;
+        this->add_small(neg, small, 0);
+    }
+    if(a.small || b.small){
+        this->mac_cross(a.sign, a.big, a.small, a.offset, b.sign, b.big, b.small, b.offset);
+    }
+}
+
+void spas_accum168_t::mac_batch(const spas_soa168_view_t& a, size_t ia, const spas_soa168_view_t& b, size_t ib, size_t n){
+    const unsigned char *a_sg = a.sign+ia, *b_sg = b.sign+ib;
+    const uint64_t *a_bg = a.big+ia, *b_bg = b.big+ib;
+    const uint64_t *a_sm = a.small+ia, *b_sm = b.small+ib;
+
+    // big*big products are summed by the dispatched kernel into positive and negative 192 bit sums / 2^128
+    uint64_t pos[3] = {0, 0, 0}, neg[3] = {0, 0, 0};
+    fraction_dot_batch_signed(a_bg, a_sg, b_bg, b_sg, n, pos, neg);
+
+    // big*small and small*big are multiplied by the dispatched batch kernel a block at a time, then added pair by pair
+    // in the same order as mac(), blocks without any small are skipped
+    const size_t block = 64;
+    uint64_t bs_hi[block], bs_lo[block], sb_hi[block], sb_lo[block];
+    for(size_t i0=0; i0<n; i0+=block){
+        size_t m = (n - i0 < block) ? n - i0 : block;
+        uint64_t any_a = 0, any_b = 0;
+        for(size_t j=i0; j<i0+m; j++){
+            any_a |= a_sm[j];
+            any_b |= b_sm[j];
+        }
+        if(!(any_a | any_b)){continue;}
+        if(any_b){fraction_multiply_batch(a_bg+i0, b_sm+i0, bs_hi, bs_lo, m);}
+        if(any_a){fraction_multiply_batch(a_sm+i0, b_bg+i0, sb_hi, sb_lo, m);}
+
+        for(size_t j=0; j<m; j++){
+            size_t i = i0+j;
+            unsigned char ab = (a_sg[i]>>3)&1, as = a_sg[i]&1, bb = (b_sg[i]>>3)&1, bs = b_sg[i]&1;
+            uint64_t a_off = a.offset[ia+i], b_off = b.offset[ib+i];
+            if(a_bg[i] && b_sm[i]){ // big*small / 2^(192+offset)
+                this->add_small(ab^bs, bs_hi[j], b_off);
+                this->add_small(ab^bs, bs_lo[j], b_off+64);
+            }
+            if(a_sm[i] && b_bg[i]){
+                this->add_small(as^bb, sb_hi[j], a_off);
+                this->add_small(as^bb, sb_lo[j], a_off+64);
+            }
+            if(a_sm[i] && b_sm[i]){ // small*small / 2^(256+offsets), rare enough to stay scalar
+                uint64_t big, small;
+                fraction_multiply(a_sm[i], b_sm[i], big, small);
+                this->add_small(as^bs, big, a_off+b_off+64);
+                this->add_small(as^bs, small, a_off+b_off+128);
+            }
+        }
+    }
+
+    // pos - neg, the upper two words go to hi and the borrow-adjusted lowest word lands on small with offset 0
+    uint64_t low = pos[0] - neg[0];
+    __int128_t upper = (__int128_t)(((__uint128_t)pos[2] << 64) | pos[1]) - (__int128_t)(((__uint128_t)neg[2] << 64) | neg[1]) - (pos[0] < neg[0]);
+    this->hi += upper;
+    this->add_small(0, low, 0);
+}
+
+void spas_accum168_t::mac_cross(unsigned char a_sign, uint64_t a_big, uint64_t a_small, uint64_t a_off, unsigned char b_sign, uint64_t b_big, uint64_t b_small, uint64_t b_off){
+    unsigned char ab = (a_sign>>3)&1, as = a_sign&1, bb = (b_sign>>3)&1, bs = b_sign&1;
+    uint64_t big, small;
+
+    if(a_big && b_small){ // big*small / 2^(192+offset)
+        fraction_multiply(a_big, b_small, big, small);
+        this->add_small(ab^bs, big, b_off);
+        this->add_small(ab^bs, small, b_off+64);
+    }
+    if(a_small && b_big){
+        fraction_multiply(a_small, b_big, big, small);
+        this->add_small(as^bb, big, a_off);
+        this->add_small(as^bb, small, a_off+64);
+    }
+    if(a_small && b_small){ // small*small / 2^(256+offsets)
+        fraction_multiply(a_small, b_small, big, small);
+        this->add_small(as^bs, big, a_off+b_off+64);
+        this->add_small(as^bs, small, a_off+b_off+128);
+    }
+}
+
+void spas_accum168_t::fold(){
+    uint64_t k = this->anchor + 96;
+    if(k >= 127){return;}
+    unsigned char neg = this->lo < 0;
+    __uint128_t m = neg ? -(__uint128_t)this->lo : (__uint128_t)this->lo;
+    __uint128_t q = m >> k;
+    if(!q){return;}
+    m -= q << k;
+    this->hi += neg ? -(__int128_t)q : (__int128_t)q;
+    this->lo = neg ? -(__int128_t)m : (__int128_t)m;
+}
+
+void spas_accum168_t::spill(){
+    if(this->anchor >= 32){
+        this->lo = this->shift_out(this->lo, 32);
+        this->anchor -= 32;
+    }
+    else{
+        this->lo = this->shift_out(this->lo, this->anchor);
+        this->anchor = 0;
+        this->fold();
+    }
+}
+
+// Assignment arithimatic operators
+spas_accum168_t& spas_accum168_t::operator+=(const spas_fract168_t& rhs){
+    this->hi += (rhs.sign&0b1000) ? -(__int128_t)rhs.big : (__int128_t)rhs.big;
+    this->add_small(rhs.sign&0b0001, rhs.small, rhs.offset);
+    return *this;
+}
+
+spas_accum168_t& spas_accum168_t::operator-=(const spas_fract168_t& rhs){
+    this->hi -= (rhs.sign&0b1000) ? -(__int128_t)rhs.big : (__int128_t)rhs.big;
+    this->add_small(!(rhs.sign&0b0001), rhs.small, rhs.offset);
+    return *this;
+}
+
+spas_accum168_t& spas_accum168_t::operator+=(const spas_accum168_t& rhs){
+    this->hi += rhs.hi;
+    this->add_wide(rhs.lo, rhs.anchor);
+    return *this;
+}
+
+spas_accum168_t& spas_accum168_t::operator-=(const spas_accum168_t& rhs){
+    this->hi -= rhs.hi;
+    this->add_wide(-rhs.lo, rhs.anchor);
+    return *this;
+}
+
+// Scaling keeps big and small as they are, there is no bit ORing between portions of different sign
+spas_accum168_t& spas_accum168_t::operator<<=(uint32_t rhs){
+    if(rhs >= 64){
+        throw std::invalid_argument("spas_accum168_t shift is out of bound!");
+    }
+    if(!rhs){return *this;}
+    this->fold(); // |lo| < 2^-64 from here on
+
+    // Past this the shifted value is beyond 1.0, and hi could overflow its guard bits
+    __uint128_t mb = this->hi < 0 ? -(__uint128_t)this->hi : (__uint128_t)this->hi;
+    if(mb > ((__uint128_t)1 << (64 - rhs))){
+        throw std::invalid_argument("spas_fract168_t overflowed!");
+    }
+
+    this->hi = (__int128_t)((__uint128_t)this->hi << rhs);
+    if(this->anchor >= rhs){ // lo only changes unit
+        this->anchor -= rhs;
+    }
+    else{
+        // Bits of lo that reach 2^-64 after the shift move into hi, k is where 2^-64 lands in lo after the shift
+        uint64_t k = this->anchor + 96 - rhs;
+        __int128_t q = this->lo >> k; // Floor, so the remainder is never negative
+        __int128_t r = this->lo - (__int128_t)((__uint128_t)q << k);
+        this->hi += q;
+        this->lo = (__int128_t)((__uint128_t)r << (rhs - this->anchor)); // r < 2^k, under 2^96 after the shift
+        this->anchor = 0;
+    }
+    return *this;
+}
+
+// Normalization
+spas_fract168_t spas_accum168_t::finalize() const{
+    return this->normalize(false);
+}
+
+spas_fract168_t spas_accum168_t::finalize_floor() const{
+    return this->normalize(true);
+}
+
+// Bit length of a 128 bit magnitude
+static inline unsigned long bit_length(__uint128_t m){
+    uint64_t high = (uint64_t)(m >> 64);
+    return high ? 128 - __builtin_clzll(high) : (m ? 64 - __builtin_clzll((uint64_t)m) : 0);
+}
+
+spas_fract168_t spas_accum168_t::normalize(bool floor) const{
+    spas_accum168_t t = *this;
+    t.fold();
+
+    // Round lo to the 64 bits small can hold
+    unsigned long n = bit_length(t.lo < 0 ? -(__uint128_t)t.lo : (__uint128_t)t.lo);
+    if(n > 64){
+        unsigned long cut = n - 64;
+        __int128_t q = t.lo >> cut;
+        if(!floor){
+            // To nearest, ties to even
+            __int128_t r = t.lo - (__int128_t)((__uint128_t)q << cut), half = (__int128_t)1 << (cut - 1);
+            q += (r > half || (r == half && (q & 1))) ? 1 : 0;
+        }
+        t.lo = (__int128_t)((__uint128_t)q << cut); // Toward -inf otherwise
+        t.fold();
+    }
+
+    unsigned char b_sign = t.hi < 0;
+    __uint128_t mb = b_sign ? -(__uint128_t)t.hi : (__uint128_t)t.hi;
+    if(mb >> 64){
+        throw std::invalid_argument("spas_fract168_t overflowed!");
+    }
+
+    unsigned char s_sign = t.lo < 0;
+    __uint128_t ms = s_sign ? -(__uint128_t)t.lo : (__uint128_t)t.lo;
+    uint64_t small = 0, offset = 0;
+    if(ms){
+        unsigned long n = bit_length(ms);
+        offset = t.anchor + 96 - n;
+        small = (n > 64) ? (uint64_t)(ms >> (n - 64)) : ((uint64_t)ms << (64 - n));
+        if(offset > UINT32_MAX){ // Beyond the range of small, treat as zero
+            small = 0;
+            offset = 0;
+            if(floor && s_sign){ // Except when rounding down, where it becomes the smallest negative small
+                small = 0x8000'0000'0000'0000;
+                offset = UINT32_MAX;
+            }
+        }
+    }
+
+    uint64_t big = (uint64_t)mb;
+    unsigned char sign = (big ? b_sign<<3 : 0) | (small ? s_sign : 0);
+    return spas_fract168_t(sign, big, (uint32_t)offset, small);
+}
+
+int spas_accum168_t::compare(const spas_accum168_t& rhs) const{
+    spas_accum168_t t = *this;
+    t -= rhs;
+    t.fold();
+    if(t.hi){return t.hi < 0 ? -1 : 1;}
+    if(t.lo){return t.lo < 0 ? -1 : 1;}
+    return 0;
+}
+
+double spas_accum168_t::getDouble() const{
+    return this->finalize().getDouble();
+}
+
+void spas_accum168_t::printAll() const{
+    this->finalize().printAll();
+}
+
+// Comparison operators
+bool operator==(const spas_accum168_t& lhs, const spas_accum168_t& rhs){
+    return lhs.compare(rhs) == 0;
+}
+
+bool operator!=(const spas_accum168_t& lhs, const spas_accum168_t& rhs){
+    return lhs.compare(rhs) != 0;
+}
+
+bool operator<(const spas_accum168_t& lhs, const spas_accum168_t& rhs){
+    return lhs.compare(rhs) < 0;
+}
+
+bool operator>(const spas_accum168_t& lhs, const spas_accum168_t& rhs){
+    return lhs.compare(rhs) > 0;
+}
+
+bool operator<=(const spas_accum168_t& lhs, const spas_accum168_t& rhs){
+    return lhs.compare(rhs) <= 0;
+}
+
+bool operator>=(const spas_accum168_t& lhs, const spas_accum168_t& rhs){
+    return lhs.compare(rhs) >= 0;
+}
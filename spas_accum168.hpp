@@ -0,0 +1,82 @@
+#ifndef spas_accum168
+#define spas_accum168
+
+#include "spas_fract168.hpp"
+#include "spas_soa168.hpp"
+
+// Unnormalized accumulator for long chains of spas_fract168_t additions
+// Skips the per-step clz renormalization and sign canonicalization of operator+=,
+// the value is only normalized back into a spas_fract168_t on finalize(), comparison or output
+
+// What happens to the bits shifted out of lo when it is realigned or spilled
+enum spas_accum_mode_t{
+    SPAS_ACCUM_NEAREST, // Rounded to nearest, the error stays far below the last bit finalize() keeps
+    SPAS_ACCUM_FLOOR // Floored, the accumulated value never exceeds the exact one
+};
+
+class spas_accum168_t{
+    public:
+        __int128_t hi; // Signed sum of big portions / 2^64, upper 63 bits are guard bits for intermediate overflow
+        __int128_t lo; // Signed sum of small portions / 2^(160+anchor), lower 32 bits are guard bits
+        uint64_t anchor; // Exponential denominator of lo, follows the largest small portion seen so far
+        spas_accum_mode_t mode; // Rounding of shifted out bits, kept across reset()
+
+        // Empty constructor, accumulator starts at zero
+        spas_accum168_t();
+        // Empty constructor with the given rounding of shifted out bits
+        explicit spas_accum168_t(spas_accum_mode_t mode);
+        // Start accumulating from an existing fraction
+        spas_accum168_t(const spas_fract168_t& t, spas_accum_mode_t mode = SPAS_ACCUM_NEAREST);
+
+        // Clear the accumulator back to zero, the mode is kept
+        void reset();
+        // Add a raw small portion (small / 2^(128+offset)), small does not need to be normalized
+        void add_small(unsigned char neg, uint64_t small, uint64_t offset);
+
+        // Multiply-accumulate, add the full a*b cross terms without building a normalized product
+        void mac(const spas_fract168_t& a, const spas_fract168_t& b);
+        // Multiply-accumulate n pairs a[ia+i]*b[ib+i], the big*big products are summed by fraction_dot_batch_signed()
+        // before touching the accumulator and the cross terms are multiplied by fraction_multiply_batch()
+        void mac_batch(const spas_soa168_view_t& a, size_t ia, const spas_soa168_view_t& b, size_t ib, size_t n);
+
+        spas_accum168_t& operator+=(const spas_fract168_t& rhs);
+        spas_accum168_t& operator-=(const spas_fract168_t& rhs);
+        spas_accum168_t& operator+=(const spas_accum168_t& rhs);
+        spas_accum168_t& operator-=(const spas_accum168_t& rhs);
+        // Multiply the accumulated value by 2^rhs exactly, rhs < 64, throws if the result is already out of (-1.0, 1.0)
+        spas_accum168_t& operator<<=(uint32_t rhs);
+
+        // Normalize the accumulated value into a spas_fract168_t rounded to nearest, throws if it is out of (-1.0, 1.0)
+        spas_fract168_t finalize() const;
+        // Same as finalize() but rounds toward -inf, the result is a lower bound of the exact value
+        // as long as the accumulator was built with SPAS_ACCUM_FLOOR
+        spas_fract168_t finalize_floor() const;
+        // Return -1, 0 or 1 when this is smaller, equal or larger than rhs
+        int compare(const spas_accum168_t& rhs) const;
+        // Return double value of the finalized fraction, suffer from aliasing!!!
+        double getDouble() const;
+        // Print the finalized fraction in hex form
+        void printAll() const;
+
+    private:
+        // Add the big*small, small*big and small*small terms of a product
+        void mac_cross(unsigned char a_sign, uint64_t a_big, uint64_t a_small, uint64_t a_off, unsigned char b_sign, uint64_t b_big, uint64_t b_small, uint64_t b_off);
+        // Shift v right by d, rounding the dropped bits as set by mode
+        __int128_t shift_out(__int128_t v, uint64_t d);
+        // Add a signed 128 bit value / 2^(160+offset) into lo
+        void add_wide(__int128_t v, uint64_t offset);
+        // Shared body of finalize() and finalize_floor()
+        spas_fract168_t normalize(bool floor) const;
+        // Fold the part of lo which reaches 2^-64 into hi
+        void fold();
+        // Make room in lo before its guard bits run out
+        void spill();
+};
+
+bool operator==(const spas_accum168_t& lhs, const spas_accum168_t& rhs);
+bool operator!=(const spas_accum168_t& lhs, const spas_accum168_t& rhs);
+bool operator<(const spas_accum168_t& lhs, const spas_accum168_t& rhs);
+bool operator>(const spas_accum168_t& lhs, const spas_accum168_t& rhs);
+bool operator<=(const spas_accum168_t& lhs, const spas_accum168_t& rhs);
+bool operator>=(const spas_accum168_t& lhs, const spas_accum168_t& rhs);
+#endif
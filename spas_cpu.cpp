@@ -0,0 +1,51 @@
+#include "spas_cpu.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+static spas_cpu_features_t detect_features(){
+    spas_cpu_features_t f;
+    memset(&f, 0, sizeof(f));
+
+    const char* env = getenv("SPAS_DISPATCH");
+    if(env && strcmp(env, "generic") == 0){return f;}
+
+#if defined(__x86_64__)
+    unsigned int eax, ebx, ecx, edx;
+    if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx)){return f;}
+
+    // AVX state has to be enabled by the OS before using any of the vector paths
+    bool os_avx = false, os_avx512 = false;
+    if((ecx & bit_OSXSAVE) && (ecx & bit_AVX)){
+        uint32_t xcr0_lo, xcr0_hi;
+        __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+        os_avx = (xcr0_lo & 0x06) == 0x06; // XMM and YMM
+        os_avx512 = (xcr0_lo & 0xE6) == 0xE6; // XMM, YMM, opmask, ZMM
+    }
+
+    if(!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)){return f;}
+    f.bmi2 = (ebx & bit_BMI2) != 0;
+    f.adx = (ebx & bit_ADX) != 0;
+    f.avx2 = os_avx && (ebx & bit_AVX2);
+    f.avx512f = os_avx512 && (ebx & bit_AVX512F);
+    f.avx512ifma = f.avx512f && (ebx & bit_AVX512IFMA);
+#endif
+    return f;
+}
+
+static spas_cpu_features_t& features(){
+    static spas_cpu_features_t f = detect_features();
+    return f;
+}
+
+const spas_cpu_features_t& spas_cpu_features(){
+    return features();
+}
+
+void spas_cpu_set_features(const spas_cpu_features_t& t){
+    features() = t;
+}
@@ -0,0 +1,20 @@
+#ifndef spas_cpu
+#define spas_cpu
+
+#include <stdint.h>
+
+// Instruction set extensions used by the runtime dispatched kernels
+struct spas_cpu_features_t{
+    bool bmi2; // MULX
+    bool adx; // ADCX and ADOX
+    bool avx2;
+    bool avx512f;
+    bool avx512ifma; // VPMADD52LUQ and VPMADD52HUQ
+};
+
+// Return the features of the running CPU, detected once with CPUID
+// Setting SPAS_DISPATCH=generic in the environment disables every extension
+const spas_cpu_features_t& spas_cpu_features();
+// Force a feature set, only use this for testing and benchmarking the fallback paths!!!
+void spas_cpu_set_features(const spas_cpu_features_t& t);
+#endif
@@ -0,0 +1,171 @@
+#include "spas_csr168.hpp"
+#include "spas_accum168.hpp"
+#include "spas_parallel.hpp"
+
+#include <algorithm>
+
+// Constructors
+spas_csr168_t::spas_csr168_t(){
+    this->rows = 0;
+    this->cols = 0;
+    this->row_ptr.assign(1, 0);
+}
+
+spas_csr168_t::spas_csr168_t(size_t rows, size_t cols){
+    if(cols > (size_t)UINT32_MAX + 1){
+        throw std::invalid_argument("spas_csr168_t has too many columns!");
+    }
+    this->rows = rows;
+    this->cols = cols;
+    this->row_ptr.assign(rows+1, 0);
+}
+
+spas_csr168_t::spas_csr168_t(size_t rows, size_t cols, const std::vector<uint32_t>& row, const std::vector<uint32_t>& col, const spas_soa168_t& values) : spas_csr168_t(rows, cols){
+    size_t n = values.size();
+    if(row.size() != n || col.size() != n){
+        throw std::invalid_argument("spas_csr168_t triplets have mismatched lengths!");
+    }
+    for(size_t i=0; i<n; i++){
+        if(row[i] >= rows || col[i] >= cols){
+            throw std::invalid_argument("spas_csr168_t triplet is out of bound!");
+        }
+        this->row_ptr[row[i]+1]++;
+    }
+    for(size_t r=0; r<rows; r++){
+        this->row_ptr[r+1] += this->row_ptr[r];
+    }
+
+    // Counting sort by row, keeps the input order within a row
+    std::vector<size_t> next(this->row_ptr.begin(), this->row_ptr.end()-1);
+    this->col_idx.resize(n);
+    this->values.resize(n);
+    for(size_t i=0; i<n; i++){
+        size_t k = next[row[i]]++;
+        this->col_idx[k] = col[i];
+        this->values.sign[k] = values.sign[i];
+        this->values.big[k] = values.big[i];
+        this->values.small[k] = values.small[i];
+        this->values.offset[k] = values.offset[i];
+    }
+}
+
+size_t spas_csr168_t::nnz() const{
+    return this->col_idx.size();
+}
+
+// First row of the part-th of parts slices holding about the same number of nonzeros
+static size_t partition_row(const spas_csr168_t& A, size_t part, unsigned parts){
+    if(part == 0){return 0;}
+    if(part >= parts){return A.rows;}
+    size_t target = (size_t)((__uint128_t)A.nnz()*part/parts);
+    return std::lower_bound(A.row_ptr.begin(), A.row_ptr.end()-1, target) - A.row_ptr.begin();
+}
+
+void spas_csr_spmv(const spas_csr168_t& A, const spas_soa168_t& x, spas_soa168_t& y, unsigned threads){
+    if(x.size() != A.cols){
+        throw std::invalid_argument("spas_csr_spmv vector length does not match the matrix!");
+    }
+    y.resize(A.rows);
+    threads = spas_thread_count(threads);
+
+    spas_parallel_run(threads, [&](unsigned t){
+        size_t r_end = partition_row(A, t+1, threads);
+        spas_accum168_t acc;
+        for(size_t r=partition_row(A, t, threads); r<r_end; r++){
+            acc.reset();
+            for(size_t k=A.row_ptr[r]; k<A.row_ptr[r+1]; k++){
+                acc.mac(A.values.get(k), x.get(A.col_idx[k]));
+            }
+            y.set(r, acc.finalize());
+        }
+    });
+}
+
+spas_csr_transpose_plan_t::spas_csr_transpose_plan_t(){
+    this->rows = 0;
+    this->cols = 0;
+    this->threads = 1;
+    this->col_list.resize(1);
+    this->merge_begin.assign(1, 0);
+}
+
+spas_csr_transpose_plan_t::spas_csr_transpose_plan_t(const spas_csr168_t& A, unsigned threads){
+    this->rows = A.rows;
+    this->cols = A.cols;
+    this->threads = spas_thread_count(threads);
+    threads = this->threads;
+
+    // Each thread only owns the columns its rows touch, so the buffers together never hold more than nnz entries
+    this->col_list.resize(threads);
+    this->slot.resize(A.nnz());
+    spas_parallel_run(threads, [&](unsigned t){
+        size_t k_begin = A.row_ptr[partition_row(A, t, threads)], k_end = A.row_ptr[partition_row(A, t+1, threads)];
+        std::vector<uint32_t>& c = this->col_list[t];
+        c.assign(A.col_idx.begin()+k_begin, A.col_idx.begin()+k_end);
+        std::sort(c.begin(), c.end());
+        c.erase(std::unique(c.begin(), c.end()), c.end());
+        c.shrink_to_fit();
+        for(size_t k=k_begin; k<k_end; k++){
+            this->slot[k] = (uint32_t)(std::lower_bound(c.begin(), c.end(), A.col_idx[k]) - c.begin());
+        }
+    });
+
+    // The merge is split evenly by column, each merging thread starts every list at its first column
+    this->merge_begin.resize((size_t)threads*threads);
+    for(unsigned t=0; t<threads; t++){
+        uint32_t c_begin = (uint32_t)(A.cols*t/threads);
+        for(unsigned p=0; p<threads; p++){
+            const std::vector<uint32_t>& c = this->col_list[p];
+            this->merge_begin[(size_t)t*threads+p] = std::lower_bound(c.begin(), c.end(), c_begin) - c.begin();
+        }
+    }
+}
+
+void spas_csr_spmv_transposed(const spas_csr168_t& A, const spas_soa168_t& x, spas_soa168_t& y, const spas_csr_transpose_plan_t& plan){
+    if(x.size() != A.rows){
+        throw std::invalid_argument("spas_csr_spmv_transposed vector length does not match the matrix!");
+    }
+    if(plan.rows != A.rows || plan.cols != A.cols || plan.slot.size() != A.nnz()){
+        throw std::invalid_argument("spas_csr_spmv_transposed plan was built for another matrix!");
+    }
+    y.resize(A.cols);
+    unsigned threads = plan.threads;
+
+    std::vector<std::vector<spas_accum168_t> > partial(threads);
+    spas_parallel_run(threads, [&](unsigned t){
+        size_t r_begin = partition_row(A, t, threads), r_end = partition_row(A, t+1, threads);
+        std::vector<spas_accum168_t>& acc = partial[t];
+        acc.resize(plan.col_list[t].size());
+        for(size_t r=r_begin; r<r_end; r++){
+            if(A.row_ptr[r] == A.row_ptr[r+1]){continue;}
+            spas_fract168_t xr = x.get(r);
+            for(size_t k=A.row_ptr[r]; k<A.row_ptr[r+1]; k++){
+                acc[plan.slot[k]].mac(A.values.get(k), xr);
+            }
+        }
+    });
+
+    // Merge the sorted column lists, split evenly by column
+    spas_parallel_run(threads, [&](unsigned t){
+        size_t c_begin = A.cols*t/threads, c_end = A.cols*(t+1)/threads;
+        std::vector<size_t> next(plan.merge_begin.begin()+(size_t)t*threads, plan.merge_begin.begin()+(size_t)(t+1)*threads);
+        spas_accum168_t acc;
+        for(size_t c=c_begin; c<c_end; c++){
+            acc.reset();
+            for(unsigned p=0; p<threads; p++){
+                const std::vector<uint32_t>& cp = plan.col_list[p];
+                if(next[p] < cp.size() && cp[next[p]] == c){
+                    acc += partial[p][next[p]++];
+                }
+            }
+            y.set(c, acc.finalize());
+        }
+    });
+}
+
+void spas_csr_spmv_transposed(const spas_csr168_t& A, const spas_soa168_t& x, spas_soa168_t& y, unsigned threads){
+    if(x.size() != A.rows){
+        throw std::invalid_argument("spas_csr_spmv_transposed vector length does not match the matrix!");
+    }
+    spas_csr_spmv_transposed(A, x, y, spas_csr_transpose_plan_t(A, threads));
+}
@@ -0,0 +1,50 @@
+#ifndef spas_csr168
+#define spas_csr168
+
+#include <vector>
+#include "spas_soa168.hpp"
+
+// Compressed sparse row matrix with spas_fract168_t entries, values are stored as structure of arrays
+class spas_csr168_t{
+    public:
+        size_t rows;
+        size_t cols;
+        std::vector<size_t> row_ptr; // Nonzeros of row r are [row_ptr[r], row_ptr[r+1])
+        std::vector<uint32_t> col_idx; // Column of each nonzero
+        spas_soa168_t values; // Value of each nonzero
+
+        // Empty constructor for a 0x0 matrix
+        spas_csr168_t();
+        // Constructor for an empty rows x cols matrix
+        spas_csr168_t(size_t rows, size_t cols);
+        // Build from coordinate triplets in any order, duplicated entries are summed by the kernels
+        spas_csr168_t(size_t rows, size_t cols, const std::vector<uint32_t>& row, const std::vector<uint32_t>& col, const spas_soa168_t& values);
+
+        size_t nnz() const;
+};
+
+// Column layout of spas_csr_spmv_transposed() for one matrix and thread count, built once and reused across calls
+// The plan only depends on row_ptr and col_idx, it has to be rebuilt if the sparsity pattern of the matrix changes
+class spas_csr_transpose_plan_t{
+    public:
+        size_t rows;
+        size_t cols;
+        unsigned threads;
+        std::vector<std::vector<uint32_t> > col_list; // Sorted unique columns touched by the rows of each thread
+        std::vector<uint32_t> slot; // Position of the column of each nonzero in the col_list of its thread
+        std::vector<size_t> merge_begin; // merge_begin[t*threads+p] is the first entry of col_list[p] merged by thread t
+
+        // Empty constructor for a 0x0 matrix
+        spas_csr_transpose_plan_t();
+        // Constructor for the sparsity pattern of A, 0 threads means one per hardware thread
+        spas_csr_transpose_plan_t(const spas_csr168_t& A, unsigned threads = 1);
+};
+
+// y = A*x, rows are split between threads by nonzero count, 0 threads means one per hardware thread
+void spas_csr_spmv(const spas_csr168_t& A, const spas_soa168_t& x, spas_soa168_t& y, unsigned threads = 1);
+// y = A^T*x, each thread accumulates into a buffer of only the columns its rows touch, summed at the end
+// Scratch memory is bounded by nnz accumulators (48 bytes per nonzero) on top of the plan, independent of the thread count
+void spas_csr_spmv_transposed(const spas_csr168_t& A, const spas_soa168_t& x, spas_soa168_t& y, const spas_csr_transpose_plan_t& plan);
+// Same as above with a plan built for this call only, the plan holds 8 bytes per nonzero
+void spas_csr_spmv_transposed(const spas_csr168_t& A, const spas_soa168_t& x, spas_soa168_t& y, unsigned threads = 1);
+#endif
@@ -0,0 +1,121 @@
+#include "spas_filter168.hpp"
+#include "spas_accum168.hpp"
+#include "spas_parallel.hpp"
+
+#include <algorithm>
+
+// Copy n fractions from src[is] into dst[id]
+static void soa_copy(spas_soa168_t& dst, size_t id, const spas_soa168_t& src, size_t is, size_t n){
+    std::copy(src.sign.begin()+is, src.sign.begin()+is+n, dst.sign.begin()+id);
+    std::copy(src.big.begin()+is, src.big.begin()+is+n, dst.big.begin()+id);
+    std::copy(src.small.begin()+is, src.small.begin()+is+n, dst.small.begin()+id);
+    std::copy(src.offset.begin()+is, src.offset.begin()+is+n, dst.offset.begin()+id);
+}
+
+// Reverse the order of the fractions in t
+static spas_soa168_t soa_reversed(const spas_soa168_t& t){
+    spas_soa168_t r(t.size());
+    for(size_t i=0; i<t.size(); i++){
+        r.set(i, t.get(t.size()-1-i));
+    }
+    return r;
+}
+
+// FIR filter
+spas_fir168_t::spas_fir168_t(const spas_soa168_t& taps) : taps(taps){
+    if(taps.size() == 0){
+        throw std::invalid_argument("spas_fir168_t constructed without taps!");
+    }
+    this->reset();
+}
+
+void spas_fir168_t::reset(){
+    this->history = spas_soa168_t(2*this->taps.size());
+    this->pos = 0;
+}
+
+void spas_fir168_t::process(const spas_soa168_t& in, spas_soa168_t& out){
+    size_t n = this->taps.size();
+    out.resize(in.size());
+    spas_accum168_t acc;
+    for(size_t i=0; i<in.size(); i++){
+        // Step back and write the sample twice, so history[pos, pos+n) never wraps
+        this->pos = (this->pos == 0) ? n-1 : this->pos-1;
+        soa_copy(this->history, this->pos, in, i, 1);
+        soa_copy(this->history, this->pos+n, in, i, 1);
+
+        acc.reset();
+        acc.mac_batch(this->taps, 0, this->history, this->pos, n);
+        out.set(i, acc.finalize());
+    }
+}
+
+// IIR filter
+spas_iir168_t::spas_iir168_t(const spas_soa168_t& coefficients, uint32_t shift) : coefficients(coefficients){
+    if(coefficients.size() == 0 || coefficients.size()%5){
+        throw std::invalid_argument("spas_iir168_t needs 5 coefficients per section!");
+    }
+    if(shift >= 64){
+        throw std::invalid_argument("spas_iir168_t coefficient shift is out of bound!");
+    }
+    this->sections = coefficients.size()/5;
+    this->shift = shift;
+    for(size_t s=0; s<this->sections; s++){ // Feedback terms are subtracted
+        this->coefficients.set(5*s+3, -coefficients.get(5*s+3));
+        this->coefficients.set(5*s+4, -coefficients.get(5*s+4));
+    }
+    this->reset();
+}
+
+void spas_iir168_t::reset(){
+    this->state = spas_soa168_t(5*this->sections);
+}
+
+void spas_iir168_t::process(const spas_soa168_t& in, spas_soa168_t& out){
+    out.resize(in.size());
+    spas_accum168_t acc;
+    for(size_t i=0; i<in.size(); i++){
+        spas_fract168_t x = in.get(i);
+        for(size_t s=0; s<this->sections; s++){
+            size_t k = 5*s;
+            // Shift the delay lines and bring in the new input
+            soa_copy(this->state, k+2, this->state, k+1, 1);
+            soa_copy(this->state, k+1, this->state, k, 1);
+            this->state.set(k, x);
+
+            acc.reset();
+            acc.mac_batch(this->coefficients, k, this->state, k, 5);
+            acc <<= this->shift;
+            x = acc.finalize();
+
+            soa_copy(this->state, k+4, this->state, k+3, 1);
+            this->state.set(k+3, x);
+        }
+        out.set(i, x);
+    }
+}
+
+// Convolution
+void spas_convolve(const spas_soa168_t& x, const spas_soa168_t& h, spas_soa168_t& y, unsigned threads){
+    if(x.size() == 0 || h.size() == 0){
+        y.resize(0);
+        return;
+    }
+    size_t nx = x.size(), nh = h.size(), ny = nx+nh-1;
+    y.resize(ny);
+    threads = spas_thread_count(threads);
+
+    // y[n] = sum h[k]*x[n-k] = sum hr[nh-1-k]*x[n-k], contiguous in both hr and x
+    spas_soa168_t hr = soa_reversed(h);
+    spas_parallel_run(threads, [&](unsigned t){
+        spas_accum168_t acc;
+        size_t n_end = ny*(t+1)/threads;
+        for(size_t n=ny*t/threads; n<n_end; n++){
+            size_t k_lo = (n+1 > nx) ? n+1-nx : 0; // Smallest k with n-k < nx
+            size_t k_hi = (n < nh-1) ? n : nh-1;
+            acc.reset();
+            acc.mac_batch(hr, nh-1-k_hi, x, n-k_hi, k_hi-k_lo+1);
+            y.set(n, acc.finalize());
+        }
+    });
+}
@@ -0,0 +1,44 @@
+#ifndef spas_filter168
+#define spas_filter168
+
+#include "spas_soa168.hpp"
+
+// Streaming FIR filter, history is kept in a ring buffer so blocks can be fed one after another
+class spas_fir168_t{
+    public:
+        // Constructor from the taps h[0], h[1], ... with y[n] = sum h[k]*x[n-k]
+        spas_fir168_t(const spas_soa168_t& taps);
+
+        // Clear the history back to zero
+        void reset();
+        // Filter a block of samples, out is resized to the length of in
+        void process(const spas_soa168_t& in, spas_soa168_t& out);
+
+    private:
+        spas_soa168_t taps;
+        spas_soa168_t history; // Doubled ring buffer, the last taps.size() samples are contiguous from pos, newest first
+        size_t pos;
+};
+
+// Streaming cascade of biquad sections in direct form I
+// Each section holds {b0, b1, b2, a1, a2} with a0 = 1, all divided by 2^shift so they fit in (-1.0, 1.0)
+class spas_iir168_t{
+    public:
+        // Constructor from 5 coefficients per section, laid out section after section
+        spas_iir168_t(const spas_soa168_t& coefficients, uint32_t shift);
+
+        // Clear the state of every section back to zero
+        void reset();
+        // Filter a block of samples, out is resized to the length of in
+        void process(const spas_soa168_t& in, spas_soa168_t& out);
+
+    private:
+        size_t sections;
+        uint32_t shift;
+        spas_soa168_t coefficients; // {b0, b1, b2, -a1, -a2} per section
+        spas_soa168_t state; // {x[n], x[n-1], x[n-2], y[n-1], y[n-2]} per section
+};
+
+// Full linear convolution y = x*h of length x.size()+h.size()-1, 0 threads means one per hardware thread
+void spas_convolve(const spas_soa168_t& x, const spas_soa168_t& h, spas_soa168_t& y, unsigned threads = 1);
+#endif
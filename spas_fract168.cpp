@@ -476,20 +476,18 @@ void fraction_multiply(uint64_t lhs, uint64_t rhs, uint64_t &big, uint64_t &smal
 
 // Return 1 if overflowed, always ensure lhs's offset is smaller than rhs's
 uint8_t fraction_addition(uint64_t &lhs, uint64_t rhs, uint32_t offset){
-    uint64_t temp = lhs;
-    if(offset<64 && offset>=0){
-        lhs += rhs >> offset;
+    if(offset<64){
+        return __builtin_add_overflow(lhs, rhs >> offset, &lhs);
     }
-    return (lhs<temp?1:0);
+    return 0;
 }
 
 // Return 1 if underflowed, always ensure lhs's offset is smaller than rhs's
 uint8_t fraction_subtraction(uint64_t &lhs, uint64_t rhs, uint32_t offset){
-    uint64_t temp = lhs;
-    if(offset<64 && offset>=0){
-        lhs -= rhs >> offset;
+    if(offset<64){
+        return __builtin_sub_overflow(lhs, rhs >> offset, &lhs);
     }
-    return (lhs>temp?1:0);
+    return 0;
 }
 
 uint8_t full_fraction_addition(unsigned char &sign, uint64_t &res, uint32_t &res_off, unsigned char l_sign, uint64_t lhs, uint32_t l_off, unsigned char r_sign, uint64_t rhs, uint32_t r_off){
@@ -0,0 +1,269 @@
+#include "spas_interval168.hpp"
+#include "spas_accum168.hpp"
+
+// Every accumulator here floors the bits it shifts out, rounding up is done by accumulating the negated value
+// and negating the floored result: -floor(-x) = ceil(x)
+
+// Directed rounding
+spas_fract168_t add_down(const spas_fract168_t& lhs, const spas_fract168_t& rhs){
+    spas_accum168_t acc(lhs, SPAS_ACCUM_FLOOR);
+    acc += rhs;
+    return acc.finalize_floor();
+}
+
+spas_fract168_t add_up(const spas_fract168_t& lhs, const spas_fract168_t& rhs){
+    spas_accum168_t acc(SPAS_ACCUM_FLOOR);
+    acc -= lhs;
+    acc -= rhs;
+    return -acc.finalize_floor();
+}
+
+spas_fract168_t sub_down(const spas_fract168_t& lhs, const spas_fract168_t& rhs){
+    spas_accum168_t acc(lhs, SPAS_ACCUM_FLOOR);
+    acc -= rhs;
+    return acc.finalize_floor();
+}
+
+spas_fract168_t sub_up(const spas_fract168_t& lhs, const spas_fract168_t& rhs){
+    spas_accum168_t acc(rhs, SPAS_ACCUM_FLOOR);
+    acc -= lhs;
+    return -acc.finalize_floor();
+}
+
+spas_fract168_t mul_down(const spas_fract168_t& lhs, const spas_fract168_t& rhs){
+    spas_accum168_t acc(SPAS_ACCUM_FLOOR);
+    acc.mac(lhs, rhs);
+    return acc.finalize_floor();
+}
+
+spas_fract168_t mul_up(const spas_fract168_t& lhs, const spas_fract168_t& rhs){
+    spas_accum168_t acc(SPAS_ACCUM_FLOOR);
+    acc.mac(-lhs, rhs);
+    return -acc.finalize_floor();
+}
+
+// Return -1, 0 or 1 following the sign of the value held in the raw words, the larger nonzero portion decides
+static inline int sign_of(unsigned char sign, uint64_t big, uint64_t small){
+    if(big){return (sign&0b1000) ? -1 : 1;}
+    if(small){return (sign&0b0001) ? -1 : 1;}
+    return 0;
+}
+
+static int sign_of(const spas_fract168_t& t){
+    return sign_of(t.sign, t.big, t.small);
+}
+
+static bool less_than(const spas_fract168_t& lhs, const spas_fract168_t& rhs){
+    return spas_accum168_t(lhs, SPAS_ACCUM_FLOOR) < spas_accum168_t(rhs, SPAS_ACCUM_FLOOR);
+}
+
+// Constructors
+spas_interval168_t::spas_interval168_t(){
+}
+
+spas_interval168_t::spas_interval168_t(const spas_fract168_t& t) : lower(t), upper(t){
+}
+
+spas_interval168_t::spas_interval168_t(const spas_fract168_t& lower, const spas_fract168_t& upper) : lower(lower), upper(upper){
+    if(less_than(upper, lower)){
+        throw std::invalid_argument("spas_interval168_t constructed with lower > upper!");
+    }
+}
+
+bool spas_interval168_t::contains(const spas_fract168_t& t) const{
+    return !less_than(t, this->lower) && !less_than(this->upper, t);
+}
+
+spas_fract168_t spas_interval168_t::width() const{
+    return sub_up(this->upper, this->lower);
+}
+
+// Assignment arithimatic operators
+spas_interval168_t& spas_interval168_t::operator+=(const spas_interval168_t& rhs){
+    spas_fract168_t l = add_down(this->lower, rhs.lower);
+    this->upper = add_up(this->upper, rhs.upper);
+    this->lower = l;
+    return *this;
+}
+
+spas_interval168_t& spas_interval168_t::operator-=(const spas_interval168_t& rhs){
+    spas_fract168_t l = sub_down(this->lower, rhs.upper);
+    this->upper = sub_up(this->upper, rhs.lower);
+    this->lower = l;
+    return *this;
+}
+
+// Pick the corners by the signs of the operands, only [-,+]*[-,+] needs all four
+static void interval_mul(const spas_fract168_t& al, const spas_fract168_t& au, const spas_fract168_t& bl, const spas_fract168_t& bu, spas_fract168_t& rl, spas_fract168_t& ru){
+    int a = (sign_of(al) >= 0) ? 1 : ((sign_of(au) <= 0) ? -1 : 0);
+    int b = (sign_of(bl) >= 0) ? 1 : ((sign_of(bu) <= 0) ? -1 : 0);
+
+    if(a == 0 && b == 0){
+        spas_fract168_t l1 = mul_down(al, bu), l2 = mul_down(au, bl);
+        spas_fract168_t u1 = mul_up(al, bl), u2 = mul_up(au, bu);
+        rl = less_than(l1, l2) ? l1 : l2;
+        ru = less_than(u1, u2) ? u2 : u1;
+        return;
+    }
+
+    const spas_fract168_t *lx, *ly, *ux, *uy;
+    if(a > 0){
+        if(b > 0){lx = &al; ly = &bl; ux = &au; uy = &bu;}
+        else if(b < 0){lx = &au; ly = &bl; ux = &al; uy = &bu;}
+        else{lx = &au; ly = &bl; ux = &au; uy = &bu;}
+    }
+    else if(a < 0){
+        if(b > 0){lx = &al; ly = &bu; ux = &au; uy = &bl;}
+        else if(b < 0){lx = &au; ly = &bu; ux = &al; uy = &bl;}
+        else{lx = &al; ly = &bu; ux = &al; uy = &bl;}
+    }
+    else{
+        if(b > 0){lx = &al; ly = &bu; ux = &au; uy = &bu;}
+        else{lx = &au; ly = &bl; ux = &al; uy = &bl;}
+    }
+    spas_fract168_t l = mul_down(*lx, *ly); // rl and ru may alias the operands
+    ru = mul_up(*ux, *uy);
+    rl = l;
+}
+
+spas_interval168_t& spas_interval168_t::operator*=(const spas_interval168_t& rhs){
+    interval_mul(this->lower, this->upper, rhs.lower, rhs.upper, this->lower, this->upper);
+    return *this;
+}
+
+// Friend Operators
+spas_interval168_t operator+(spas_interval168_t lhs, const spas_interval168_t& rhs){
+    return lhs += rhs;
+}
+
+spas_interval168_t operator-(spas_interval168_t lhs, const spas_interval168_t& rhs){
+    return lhs -= rhs;
+}
+
+spas_interval168_t operator*(spas_interval168_t lhs, const spas_interval168_t& rhs){
+    return lhs *= rhs;
+}
+
+spas_interval168_t operator-(const spas_interval168_t& rhs){
+    spas_interval168_t t;
+    t.lower = -rhs.upper;
+    t.upper = -rhs.lower;
+    return t;
+}
+
+// Structure of arrays
+spas_interval_soa168_t::spas_interval_soa168_t(){
+}
+
+spas_interval_soa168_t::spas_interval_soa168_t(size_t n) : lower(n), upper(n){
+}
+
+size_t spas_interval_soa168_t::size() const{
+    return this->lower.size();
+}
+
+void spas_interval_soa168_t::resize(size_t n){
+    this->lower.resize(n);
+    this->upper.resize(n);
+}
+
+spas_interval168_t spas_interval_soa168_t::get(size_t i) const{
+    spas_interval168_t t;
+    t.lower = this->lower.get(i);
+    t.upper = this->upper.get(i);
+    return t;
+}
+
+void spas_interval_soa168_t::set(size_t i, const spas_interval168_t& t){
+    this->lower.set(i, t.lower);
+    this->upper.set(i, t.upper);
+}
+
+// Batch kernels
+static void check_batch(const spas_interval_soa168_t& a, const spas_interval_soa168_t& b, spas_interval_soa168_t& r){
+    if(a.size() != b.size()){
+        throw std::invalid_argument("spas_interval168_t batch operands have mismatched lengths!");
+    }
+    r.resize(a.size());
+}
+
+void spas_interval_add_batch(const spas_interval_soa168_t& a, const spas_interval_soa168_t& b, spas_interval_soa168_t& r){
+    check_batch(a, b, r);
+    spas_accum168_t acc(SPAS_ACCUM_FLOOR);
+    for(size_t i=0; i<a.size(); i++){
+        acc.reset();
+        acc += a.lower.get(i);
+        acc += b.lower.get(i);
+        r.lower.set(i, acc.finalize_floor());
+        acc.reset();
+        acc -= a.upper.get(i);
+        acc -= b.upper.get(i);
+        r.upper.set(i, -acc.finalize_floor());
+    }
+}
+
+void spas_interval_sub_batch(const spas_interval_soa168_t& a, const spas_interval_soa168_t& b, spas_interval_soa168_t& r){
+    check_batch(a, b, r);
+    spas_accum168_t acc(SPAS_ACCUM_FLOOR);
+    for(size_t i=0; i<a.size(); i++){
+        acc.reset();
+        acc += a.lower.get(i);
+        acc -= b.upper.get(i);
+        r.lower.set(i, acc.finalize_floor());
+        acc.reset();
+        acc += b.lower.get(i);
+        acc -= a.upper.get(i);
+        r.upper.set(i, -acc.finalize_floor());
+    }
+}
+
+// Corner products straight from the SoA words, the sign class of each operand decides which bounds pair up
+// Both straddling zero is rare and goes through interval_mul()
+void spas_interval_mul_batch(const spas_interval_soa168_t& a, const spas_interval_soa168_t& b, spas_interval_soa168_t& r){
+    check_batch(a, b, r);
+    const spas_soa168_t *al = &a.lower, *au = &a.upper, *bl = &b.lower, *bu = &b.upper;
+    spas_accum168_t acc(SPAS_ACCUM_FLOOR);
+    for(size_t i=0; i<a.size(); i++){
+        int ca = (sign_of(al->sign[i], al->big[i], al->small[i]) >= 0) ? 1 : ((sign_of(au->sign[i], au->big[i], au->small[i]) <= 0) ? -1 : 0);
+        int cb = (sign_of(bl->sign[i], bl->big[i], bl->small[i]) >= 0) ? 1 : ((sign_of(bu->sign[i], bu->big[i], bu->small[i]) <= 0) ? -1 : 0);
+
+        const spas_soa168_t *lx, *ly, *ux, *uy; // Same pairing as interval_mul()
+        if(ca > 0){
+            lx = (cb > 0) ? al : au; ly = bl; ux = (cb < 0) ? al : au; uy = bu;
+        }
+        else if(ca < 0){
+            lx = (cb >= 0) ? al : au; ly = bu; ux = (cb > 0) ? au : al; uy = bl;
+        }
+        else if(cb > 0){
+            lx = al; ly = bu; ux = au; uy = bu;
+        }
+        else if(cb < 0){
+            lx = au; ly = bl; ux = al; uy = bl;
+        }
+        else{
+            spas_fract168_t rl, ru;
+            interval_mul(al->get(i), au->get(i), bl->get(i), bu->get(i), rl, ru);
+            r.lower.set(i, rl);
+            r.upper.set(i, ru);
+            continue;
+        }
+
+        // Upper bound is -floor(-x*y), the negation is a flip of both sign bits
+        acc.reset();
+        acc.mac(spas_fract168_t(lx->sign[i], lx->big[i], lx->offset[i], lx->small[i]), spas_fract168_t(ly->sign[i], ly->big[i], ly->offset[i], ly->small[i]));
+        spas_fract168_t l = acc.finalize_floor();
+        acc.reset();
+        acc.mac(spas_fract168_t(ux->sign[i]^0b1001, ux->big[i], ux->offset[i], ux->small[i]), spas_fract168_t(uy->sign[i], uy->big[i], uy->offset[i], uy->small[i]));
+        spas_fract168_t u = acc.finalize_floor();
+
+        // r may be a or b, every operand word of i is read by now
+        r.lower.sign[i] = l.sign;
+        r.lower.big[i] = l.big;
+        r.lower.small[i] = l.small;
+        r.lower.offset[i] = l.offset;
+        r.upper.sign[i] = u.sign^0b1001;
+        r.upper.big[i] = u.big;
+        r.upper.small[i] = u.small;
+        r.upper.offset[i] = u.offset;
+    }
+}
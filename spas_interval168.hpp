@@ -0,0 +1,66 @@
+#ifndef spas_interval168
+#define spas_interval168
+
+#include "spas_soa168.hpp"
+
+// Directed rounding of single operations, the _down result never exceeds the exact value and _up never falls below it
+spas_fract168_t add_down(const spas_fract168_t& lhs, const spas_fract168_t& rhs);
+spas_fract168_t add_up(const spas_fract168_t& lhs, const spas_fract168_t& rhs);
+spas_fract168_t sub_down(const spas_fract168_t& lhs, const spas_fract168_t& rhs);
+spas_fract168_t sub_up(const spas_fract168_t& lhs, const spas_fract168_t& rhs);
+spas_fract168_t mul_down(const spas_fract168_t& lhs, const spas_fract168_t& rhs);
+spas_fract168_t mul_up(const spas_fract168_t& lhs, const spas_fract168_t& rhs);
+
+// Closed interval [lower, upper] enclosing a value, every operation rounds lower down and upper up
+class spas_interval168_t{
+    public:
+        spas_fract168_t lower;
+        spas_fract168_t upper;
+
+        // Empty constructor for the point 0
+        spas_interval168_t();
+        // Constructor for a point interval
+        spas_interval168_t(const spas_fract168_t& t);
+        // Constructor from bounds, throws if lower > upper
+        spas_interval168_t(const spas_fract168_t& lower, const spas_fract168_t& upper);
+
+        // Return true if t lies within the interval
+        bool contains(const spas_fract168_t& t) const;
+        // Return upper-lower, rounded up
+        spas_fract168_t width() const;
+
+        spas_interval168_t& operator+=(const spas_interval168_t& rhs);
+        spas_interval168_t& operator-=(const spas_interval168_t& rhs);
+        spas_interval168_t& operator*=(const spas_interval168_t& rhs);
+};
+
+spas_interval168_t operator+(spas_interval168_t lhs, const spas_interval168_t& rhs);
+spas_interval168_t operator-(spas_interval168_t lhs, const spas_interval168_t& rhs);
+spas_interval168_t operator*(spas_interval168_t lhs, const spas_interval168_t& rhs);
+// Inverter
+spas_interval168_t operator-(const spas_interval168_t& rhs);
+
+// Structure of arrays holding a series of intervals
+class spas_interval_soa168_t{
+    public:
+        spas_soa168_t lower;
+        spas_soa168_t upper;
+
+        // Empty constructor
+        spas_interval_soa168_t();
+        // Constructor for n zero intervals
+        explicit spas_interval_soa168_t(size_t n);
+
+        size_t size() const;
+        void resize(size_t n);
+        spas_interval168_t get(size_t i) const;
+        void set(size_t i, const spas_interval168_t& t);
+};
+
+// Element-wise r[i] = a[i] op b[i], r is resized to the length of a
+// Each bound is one unnormalized accumulation and one normalization, mul only needs all four corner products
+// when both operands straddle zero
+void spas_interval_add_batch(const spas_interval_soa168_t& a, const spas_interval_soa168_t& b, spas_interval_soa168_t& r);
+void spas_interval_sub_batch(const spas_interval_soa168_t& a, const spas_interval_soa168_t& b, spas_interval_soa168_t& r);
+void spas_interval_mul_batch(const spas_interval_soa168_t& a, const spas_interval_soa168_t& b, spas_interval_soa168_t& r);
+#endif
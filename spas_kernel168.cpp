@@ -0,0 +1,141 @@
+#include "spas_kernel168.hpp"
+#include "spas_cpu.hpp"
+#include "spas_fract168.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Portable fallbacks
+void _fraction_multiply_batch_generic(const uint64_t* lhs, const uint64_t* rhs, uint64_t* big, uint64_t* small, size_t n){
+    for(size_t i=0; i<n; i++){
+        fraction_multiply(lhs[i], rhs[i], big[i], small[i]);
+    }
+}
+
+void _fraction_dot_batch_signed_generic(const uint64_t* lhs, const unsigned char* lhs_sign, const uint64_t* rhs, const unsigned char* rhs_sign, size_t n, uint64_t pos[3], uint64_t neg[3]){
+    __uint128_t sum[2] = {((__uint128_t)pos[1] << 64) | pos[0], ((__uint128_t)neg[1] << 64) | neg[0]};
+    uint64_t top[2] = {pos[2], neg[2]};
+    for(size_t i=0; i<n; i++){
+        int k = ((lhs_sign[i]^rhs_sign[i])>>3)&1;
+        __uint128_t p = (__uint128_t)lhs[i]*(__uint128_t)rhs[i];
+        sum[k] += p;
+        top[k] += (sum[k] < p) ? 1 : 0;
+    }
+    pos[0] = (uint64_t)sum[0];
+    pos[1] = (uint64_t)(sum[0] >> 64);
+    pos[2] = top[0];
+    neg[0] = (uint64_t)sum[1];
+    neg[1] = (uint64_t)(sum[1] >> 64);
+    neg[2] = top[1];
+}
+
+#if defined(__x86_64__)
+__attribute__((target("bmi2")))
+static void fraction_multiply_batch_mulx(const uint64_t* lhs, const uint64_t* rhs, uint64_t* big, uint64_t* small, size_t n){
+    for(size_t i=0; i<n; i++){
+        unsigned long long hi;
+        small[i] = _mulx_u64(lhs[i], rhs[i], &hi);
+        big[i] = hi;
+    }
+}
+
+// Add x into the 192 bit c with ADCX (CF chain) and y into o with ADOX (OF chain)
+// The compiler never emits ADCX/ADOX for _addcarryx_u64, so the two chains are written out explicitly
+// Neither top word can carry out, so both flags are clear again when the block ends
+static inline void adx_add_pair(unsigned long long& c0, unsigned long long& c1, unsigned long long& c2, unsigned long long xl, unsigned long long xh,
+                                unsigned long long& o0, unsigned long long& o1, unsigned long long& o2, unsigned long long yl, unsigned long long yh){
+    unsigned long long zero;
+    __asm__("xorl %k[z], %k[z]\n\t" // Clears CF and OF
+            "adcxq %[xl], %[c0]\n\t"
+            "adoxq %[yl], %[o0]\n\t"
+            "adcxq %[xh], %[c1]\n\t"
+            "adoxq %[yh], %[o1]\n\t"
+            "adcxq %[z], %[c2]\n\t"
+            "adoxq %[z], %[o2]"
+            : [c0] "+r"(c0), [c1] "+r"(c1), [c2] "+r"(c2), [o0] "+r"(o0), [o1] "+r"(o1), [o2] "+r"(o2), [z] "=&r"(zero)
+            : [xl] "rm"(xl), [xh] "rm"(xh), [yl] "rm"(yl), [yh] "rm"(yh)
+            : "cc");
+}
+
+// Each product is masked into both chains, positive part on CF and negative part on OF, so there is no branch on the sign
+__attribute__((target("bmi2,adx")))
+static void fraction_dot_batch_signed_adx(const uint64_t* lhs, const unsigned char* lhs_sign, const uint64_t* rhs, const unsigned char* rhs_sign, size_t n, uint64_t pos[3], uint64_t neg[3]){
+    unsigned long long p0 = pos[0], p1 = pos[1], p2 = pos[2];
+    unsigned long long n0 = neg[0], n1 = neg[1], n2 = neg[2];
+    for(size_t i=0; i<n; i++){
+        unsigned long long h, l;
+        l = _mulx_u64(lhs[i], rhs[i], &h);
+        unsigned long long m = -(unsigned long long)(((lhs_sign[i]^rhs_sign[i])>>3)&1); // All ones when the product is negative
+        adx_add_pair(p0, p1, p2, l & ~m, h & ~m, n0, n1, n2, l & m, h & m);
+    }
+    pos[0] = p0;
+    pos[1] = p1;
+    pos[2] = p2;
+    neg[0] = n0;
+    neg[1] = n1;
+    neg[2] = n2;
+}
+
+// Split each operand into 52 bit limbs (a = a0 + a1*2^52, a1 has only 12 bits) and rebuild the 128 bit product
+// r0 = lo(a0*b0), r1 = hi(a0*b0) + lo(a0*b1) + lo(a1*b0), r2 = hi(a0*b1) + hi(a1*b0) + a1*b1
+__attribute__((target("avx512f,avx512ifma")))
+static void fraction_multiply_batch_ifma(const uint64_t* lhs, const uint64_t* rhs, uint64_t* big, uint64_t* small, size_t n){
+    const __m512i mask52 = _mm512_set1_epi64(0x000F'FFFF'FFFF'FFFF);
+    const __m512i zero = _mm512_setzero_si512();
+    size_t i = 0;
+    for(; i+8<=n; i+=8){
+        __m512i a = _mm512_loadu_si512((const void*)(lhs+i));
+        __m512i b = _mm512_loadu_si512((const void*)(rhs+i));
+        __m512i a0 = _mm512_and_si512(a, mask52), a1 = _mm512_srli_epi64(a, 52);
+        __m512i b0 = _mm512_and_si512(b, mask52), b1 = _mm512_srli_epi64(b, 52);
+
+        __m512i r0 = _mm512_madd52lo_epu64(zero, a0, b0);
+        __m512i r1 = _mm512_madd52hi_epu64(zero, a0, b0);
+        r1 = _mm512_madd52lo_epu64(r1, a0, b1);
+        r1 = _mm512_madd52lo_epu64(r1, a1, b0);
+        __m512i r2 = _mm512_madd52hi_epu64(zero, a0, b1);
+        r2 = _mm512_madd52hi_epu64(r2, a1, b0);
+        r2 = _mm512_madd52lo_epu64(r2, a1, b1);
+
+        // Carry propagation between limbs
+        r1 = _mm512_add_epi64(r1, _mm512_srli_epi64(r0, 52));
+        r0 = _mm512_and_si512(r0, mask52);
+        r2 = _mm512_add_epi64(r2, _mm512_srli_epi64(r1, 52));
+        r1 = _mm512_and_si512(r1, mask52);
+
+        __m512i lo = _mm512_or_si512(r0, _mm512_slli_epi64(r1, 52));
+        __m512i hi = _mm512_or_si512(_mm512_srli_epi64(r1, 12), _mm512_slli_epi64(r2, 40));
+        _mm512_storeu_si512((void*)(small+i), lo);
+        _mm512_storeu_si512((void*)(big+i), hi);
+    }
+    fraction_multiply_batch_mulx(lhs+i, rhs+i, big+i, small+i, n-i);
+}
+#endif
+
+// Dispatchers
+void fraction_multiply_batch(const uint64_t* lhs, const uint64_t* rhs, uint64_t* big, uint64_t* small, size_t n){
+#if defined(__x86_64__)
+    const spas_cpu_features_t& f = spas_cpu_features();
+    if(f.avx512ifma && f.bmi2){
+        fraction_multiply_batch_ifma(lhs, rhs, big, small, n);
+        return;
+    }
+    if(f.bmi2){
+        fraction_multiply_batch_mulx(lhs, rhs, big, small, n);
+        return;
+    }
+#endif
+    _fraction_multiply_batch_generic(lhs, rhs, big, small, n);
+}
+
+void fraction_dot_batch_signed(const uint64_t* lhs, const unsigned char* lhs_sign, const uint64_t* rhs, const unsigned char* rhs_sign, size_t n, uint64_t pos[3], uint64_t neg[3]){
+#if defined(__x86_64__)
+    const spas_cpu_features_t& f = spas_cpu_features();
+    if(f.bmi2 && f.adx){
+        fraction_dot_batch_signed_adx(lhs, lhs_sign, rhs, rhs_sign, n, pos, neg);
+        return;
+    }
+#endif
+    _fraction_dot_batch_signed_generic(lhs, lhs_sign, rhs, rhs_sign, n, pos, neg);
+}
@@ -0,0 +1,19 @@
+#ifndef spas_kernel168
+#define spas_kernel168
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Batch kernels over arrays of fraction words, dispatched at runtime on the features from spas_cpu_features()
+// Each kernel has a portable fallback, a MULX/ADX path and where it pays off an AVX-512 IFMA path
+
+// Multiply lhs[i] by rhs[i] and return value in big[i] and small[i] portions
+void fraction_multiply_batch(const uint64_t* lhs, const uint64_t* rhs, uint64_t* big, uint64_t* small, size_t n);
+// Signed dot product, lhs_sign[i]^rhs_sign[i] & 0b1000 marks a negative product as in spas_fract168_t::sign
+// Positive and negative products are summed into separate 192 bit accumulators, pos - neg is the result
+void fraction_dot_batch_signed(const uint64_t* lhs, const unsigned char* lhs_sign, const uint64_t* rhs, const unsigned char* rhs_sign, size_t n, uint64_t pos[3], uint64_t neg[3]);
+
+// Portable fallbacks, always available
+void _fraction_multiply_batch_generic(const uint64_t* lhs, const uint64_t* rhs, uint64_t* big, uint64_t* small, size_t n);
+void _fraction_dot_batch_signed_generic(const uint64_t* lhs, const unsigned char* lhs_sign, const uint64_t* rhs, const unsigned char* rhs_sign, size_t n, uint64_t pos[3], uint64_t neg[3]);
+#endif
@@ -0,0 +1,41 @@
+#ifndef spas_parallel
+#define spas_parallel
+
+#include <exception>
+#include <thread>
+#include <vector>
+
+// Resolve a requested thread count, 0 means one thread per hardware thread
+inline unsigned spas_thread_count(unsigned threads){
+    if(threads){return threads;}
+    unsigned t = std::thread::hardware_concurrency();
+    return t ? t : 1;
+}
+
+// Run f(t) for t in [0, threads) on separate threads and wait for all of them
+// The first exception thrown by any worker is rethrown on the calling thread
+template<typename F>
+void spas_parallel_run(unsigned threads, F f){
+    if(threads <= 1){
+        f(0u);
+        return;
+    }
+    std::vector<std::thread> pool;
+    std::vector<std::exception_ptr> errors(threads);
+    pool.reserve(threads-1);
+    for(unsigned t=1; t<threads; t++){
+        pool.emplace_back([&f, &errors, t](){
+            try{ f(t); }
+            catch(...){ errors[t] = std::current_exception(); }
+        });
+    }
+    try{ f(0u); }
+    catch(...){ errors[0] = std::current_exception(); }
+    for(size_t i=0; i<pool.size(); i++){
+        pool[i].join();
+    }
+    for(unsigned t=0; t<threads; t++){
+        if(errors[t]){std::rethrow_exception(errors[t]);}
+    }
+}
+#endif
@@ -0,0 +1,142 @@
+#include "spas_poly168.hpp"
+#include "spas_parallel.hpp"
+
+// Independent evaluations interleaved to hide the multiply latency
+static const size_t LANES = 4;
+
+// Return true if [a, a+a_bytes) and [b, b+b_bytes) share a byte
+static bool ranges_overlap(const void* a, size_t a_bytes, const void* b, size_t b_bytes){
+    uintptr_t pa = (uintptr_t)a, pb = (uintptr_t)b;
+    return pa < pb + b_bytes && pb < pa + a_bytes;
+}
+
+// Constructors
+spas_poly168_t::spas_poly168_t(const spas_soa168_t& coefficients) : coefficients(coefficients){
+    if(coefficients.size() == 0){
+        throw std::invalid_argument("spas_poly168_t constructed without coefficients!");
+    }
+    this->preload.resize(coefficients.size());
+    for(size_t k=0; k<coefficients.size(); k++){
+        this->preload[k] += coefficients.get(k);
+    }
+}
+
+size_t spas_poly168_t::degree() const{
+    return this->coefficients.size()-1;
+}
+
+// y = c[k] + y*x from k = n-1 down to 0
+void spas_poly168_t::horner_block(const spas_soa168_view_t& x, size_t i, size_t count, const spas_soa168_span_t& y) const{
+    spas_fract168_t xv[LANES], yv[LANES];
+    spas_accum168_t acc[LANES];
+    size_t n = this->degree();
+    for(size_t j=0; j<count; j++){
+        xv[j] = x.get(i+j);
+        yv[j] = this->coefficients.get(n);
+    }
+    for(size_t k=n; k-->0;){
+        for(size_t j=0; j<count; j++){
+            acc[j] = this->preload[k];
+            acc[j].mac(yv[j], xv[j]);
+            yv[j] = acc[j].finalize();
+        }
+    }
+    for(size_t j=0; j<count; j++){
+        y.set(i+j, yv[j]);
+    }
+}
+
+// q[i] = q[2i] + q[2i+1]*x^(2^level) until one term is left
+void spas_poly168_t::estrin_block(const spas_soa168_view_t& x, size_t i, size_t count, const spas_soa168_span_t& y, std::vector<spas_fract168_t>* scratch) const{
+    spas_fract168_t xp[LANES];
+    spas_accum168_t acc[LANES];
+    size_t m = this->coefficients.size();
+
+    // The first level starts from the preloaded even coefficients
+    for(size_t j=0; j<count; j++){
+        xp[j] = x.get(i+j);
+        scratch[j].resize((m+1)/2);
+    }
+    for(size_t t=0; 2*t<m; t++){
+        for(size_t j=0; j<count; j++){
+            acc[j] = this->preload[2*t];
+            if(2*t+1 < m){
+                acc[j].mac(this->coefficients.get(2*t+1), xp[j]);
+            }
+            scratch[j][t] = acc[j].finalize();
+        }
+    }
+    m = (m+1)/2;
+
+    while(m > 1){
+        for(size_t j=0; j<count; j++){
+            acc[j].reset();
+            acc[j].mac(xp[j], xp[j]);
+            xp[j] = acc[j].finalize();
+        }
+        for(size_t t=0; 2*t<m; t++){
+            for(size_t j=0; j<count; j++){
+                acc[j].reset();
+                acc[j] += scratch[j][2*t];
+                if(2*t+1 < m){
+                    acc[j].mac(scratch[j][2*t+1], xp[j]);
+                }
+                scratch[j][t] = acc[j].finalize();
+            }
+        }
+        m = (m+1)/2;
+    }
+
+    for(size_t j=0; j<count; j++){
+        y.set(i+j, scratch[j][0]);
+    }
+}
+
+spas_fract168_t spas_poly168_t::evaluate(const spas_fract168_t& x, spas_poly_scheme_t scheme) const{
+    spas_soa168_t xs(1), ys(1);
+    xs.set(0, x);
+    this->evaluate(xs, ys, scheme, 1);
+    return ys.get(0);
+}
+
+void spas_poly168_t::evaluate(const spas_soa168_t& x, spas_soa168_t& y, spas_poly_scheme_t scheme, unsigned threads) const{
+    y.resize(x.size());
+    this->evaluate(spas_soa168_view_t(x), spas_soa168_span_t(y), scheme, threads);
+}
+
+void spas_poly168_t::evaluate(const spas_soa168_view_t& x, const spas_soa168_span_t& y, spas_poly_scheme_t scheme, unsigned threads) const{
+    size_t n = x.size();
+    if(y.size() != n){
+        throw std::invalid_argument("spas_poly168_t output length does not match the input!");
+    }
+    // Blocks only protect against y being exactly x, any other overlap would read outputs back as inputs
+    const void* xf[4] = {x.sign, x.big, x.small, x.offset};
+    const void* yf[4] = {y.sign, y.big, y.small, y.offset};
+    const size_t width[4] = {1, 8, 8, 4};
+    for(int p=0; n && p<4; p++){
+        for(int q=0; q<4; q++){
+            if(p == q && xf[p] == yf[q]){continue;}
+            if(ranges_overlap(xf[p], width[p]*n, yf[q], width[q]*n)){
+                throw std::invalid_argument("spas_poly168_t output partially overlaps the input!");
+            }
+        }
+    }
+    threads = spas_thread_count(threads);
+
+    // Split by blocks of LANES so every thread runs full interleaved blocks except the last one
+    size_t blocks = (n+LANES-1)/LANES;
+    spas_parallel_run(threads, [&](unsigned t){
+        std::vector<spas_fract168_t> scratch[LANES];
+        size_t b_end = blocks*(t+1)/threads;
+        for(size_t b=blocks*t/threads; b<b_end; b++){
+            size_t i = b*LANES;
+            size_t count = (n-i < LANES) ? n-i : LANES;
+            if(scheme == SPAS_POLY_ESTRIN){
+                this->estrin_block(x, i, count, y, scratch);
+            }
+            else{
+                this->horner_block(x, i, count, y);
+            }
+        }
+    });
+}
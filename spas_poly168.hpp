@@ -0,0 +1,36 @@
+#ifndef spas_poly168
+#define spas_poly168
+
+#include <vector>
+#include "spas_accum168.hpp"
+
+// Evaluation scheme of spas_poly168_t
+enum spas_poly_scheme_t{
+    SPAS_POLY_HORNER, // n dependent multiply-adds, every intermediate (c[k] + y*x) has to stay in (-1.0, 1.0)
+    SPAS_POLY_ESTRIN // log2(n) levels of independent multiply-adds on x, x^2, x^4, ... every partial sum has to stay in (-1.0, 1.0)
+};
+
+// Fixed polynomial c[0] + c[1]*x + ... + c[n]*x^n evaluated over arrays of inputs
+class spas_poly168_t{
+    public:
+        // Constructor from the coefficients, lowest order first
+        spas_poly168_t(const spas_soa168_t& coefficients);
+
+        size_t degree() const;
+        // Evaluate at a single point
+        spas_fract168_t evaluate(const spas_fract168_t& x, spas_poly_scheme_t scheme = SPAS_POLY_HORNER) const;
+        // Evaluate at every x[i] into y[i], 0 threads means one per hardware thread
+        void evaluate(const spas_soa168_t& x, spas_soa168_t& y, spas_poly_scheme_t scheme = SPAS_POLY_HORNER, unsigned threads = 1) const;
+        // Same over views, y has to be as long as x and may be the same memory, throws otherwise
+        void evaluate(const spas_soa168_view_t& x, const spas_soa168_span_t& y, spas_poly_scheme_t scheme = SPAS_POLY_HORNER, unsigned threads = 1) const;
+
+    private:
+        spas_soa168_t coefficients;
+        std::vector<spas_accum168_t> preload; // Each coefficient already decomposed into an accumulator
+
+        // Evaluate count <= LANES inputs starting at x[i], interleaving the independent chains
+        // Every input of the block is read before any output is written, so y may be x
+        void horner_block(const spas_soa168_view_t& x, size_t i, size_t count, const spas_soa168_span_t& y) const;
+        void estrin_block(const spas_soa168_view_t& x, size_t i, size_t count, const spas_soa168_span_t& y, std::vector<spas_fract168_t>* scratch) const;
+};
+#endif
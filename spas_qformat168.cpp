@@ -0,0 +1,169 @@
+#include "spas_qformat168.hpp"
+#include "spas_cpu.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// Import
+
+// Convert one Qn word, v is sign extended to 64 bits
+static inline void import_word(int64_t v, unsigned n, unsigned char& sign, uint64_t& big, uint64_t& small, uint32_t& offset){
+    uint64_t m = (uint64_t)(v >> 63); // All ones when negative
+    uint64_t mag = ((uint64_t)v ^ m) - m;
+    sign = (unsigned char)(m & 0b1000);
+    big = mag << (64-n);
+    small = 0;
+    offset = 0;
+    if(mag >> n){ // INT_MIN is -1.0
+        sign = 0b1001;
+        big = 0xFFFF'FFFF'FFFF'FFFF;
+        small = 0xFFFF'FFFF'FFFF'FFFF;
+    }
+}
+
+template<typename T>
+static void import_generic(const T* in, size_t n, unsigned bits, unsigned char* sign, uint64_t* big, uint64_t* small, uint32_t* offset){
+    for(size_t i=0; i<n; i++){
+        import_word((int64_t)in[i], bits, sign[i], big[i], small[i], offset[i]);
+    }
+}
+
+#if defined(__x86_64__)
+// Sign extend 4 words to 64 bit lanes
+__attribute__((target("avx2")))
+static inline __m256i load_q4(const int16_t* in){
+    return _mm256_cvtepi16_epi64(_mm_loadl_epi64((const __m128i*)in));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i load_q4(const int32_t* in){
+    return _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)in));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i load_q4(const int64_t* in){
+    return _mm256_loadu_si256((const __m256i*)in);
+}
+
+// 4 words per iteration, groups holding INT_MIN fall back to import_word
+template<typename T>
+__attribute__((target("avx2,bmi2")))
+static void import_avx2(const T* in, size_t n, unsigned bits, unsigned char* sign, uint64_t* big, uint64_t* small, uint32_t* offset){
+    const __m256i zero = _mm256_setzero_si256();
+    const __m128i shift = _mm_cvtsi32_si128(64-bits);
+    const __m128i range = _mm_cvtsi32_si128(bits);
+    size_t i = 0;
+    for(; i+4<=n; i+=4){
+        __m256i v = load_q4(in+i);
+        __m256i m = _mm256_cmpgt_epi64(zero, v);
+        __m256i mag = _mm256_sub_epi64(_mm256_xor_si256(v, m), m);
+        if(!_mm256_testz_si256(_mm256_srl_epi64(mag, range), _mm256_srl_epi64(mag, range))){
+            import_generic(in+i, 4, bits, sign+i, big+i, small+i, offset+i);
+            continue;
+        }
+        _mm256_storeu_si256((__m256i*)(big+i), _mm256_sll_epi64(mag, shift));
+        _mm256_storeu_si256((__m256i*)(small+i), zero);
+        _mm_storeu_si128((__m128i*)(offset+i), _mm_setzero_si128());
+        int neg = _mm256_movemask_pd(_mm256_castsi256_pd(m));
+        uint32_t packed = (uint32_t)_pdep_u32(neg, 0x0808'0808); // One 0b1000 byte per negative lane
+        memcpy(sign+i, &packed, sizeof(packed));
+    }
+    import_generic(in+i, n-i, bits, sign+i, big+i, small+i, offset+i);
+}
+#endif
+
+template<typename T>
+static void import_soa(const T* in, size_t n, unsigned bits, spas_soa168_t& out){
+    out.resize(n);
+#if defined(__x86_64__)
+    const spas_cpu_features_t& f = spas_cpu_features();
+    if(f.avx2 && f.bmi2){
+        import_avx2(in, n, bits, out.sign.data(), out.big.data(), out.small.data(), out.offset.data());
+        return;
+    }
+#endif
+    import_generic(in, n, bits, out.sign.data(), out.big.data(), out.small.data(), out.offset.data());
+}
+
+template<typename T>
+static void import_aos(const T* in, size_t n, unsigned bits, spas_fract168_t* out){
+    for(size_t i=0; i<n; i++){
+        import_word((int64_t)in[i], bits, out[i].sign, out[i].big, out[i].small, out[i].offset);
+    }
+}
+
+void spas_from_q15(const int16_t* in, size_t n, spas_soa168_t& out){import_soa(in, n, 15, out);}
+void spas_from_q31(const int32_t* in, size_t n, spas_soa168_t& out){import_soa(in, n, 31, out);}
+void spas_from_q63(const int64_t* in, size_t n, spas_soa168_t& out){import_soa(in, n, 63, out);}
+void spas_from_q15(const int16_t* in, size_t n, spas_fract168_t* out){import_aos(in, n, 15, out);}
+void spas_from_q31(const int32_t* in, size_t n, spas_fract168_t* out){import_aos(in, n, 31, out);}
+void spas_from_q63(const int64_t* in, size_t n, spas_fract168_t* out){import_aos(in, n, 63, out);}
+
+// Export
+
+// Convert one fraction into a Qn word, clipped is incremented when the rounded word is out of range
+static inline int64_t export_word(unsigned char sign, uint64_t big, uint64_t small, unsigned n, spas_round_t round, bool saturate, size_t& clipped){
+    unsigned char b_neg = (sign>>3)&1, s_neg = sign&1;
+
+    // Magnitude in units of 2^-64 is b + e, with b an integer and e in [0, 1)
+    unsigned char neg;
+    uint64_t b;
+    bool e = small != 0;
+    if(!big){
+        neg = e ? s_neg : 0;
+        b = 0;
+    }
+    else if(!e || b_neg == s_neg){
+        neg = b_neg;
+        b = big;
+    }
+    else{ // big - small = (big-1) + (1-small)
+        neg = b_neg;
+        b = big-1;
+    }
+
+    unsigned k = 64-n;
+    uint64_t q = b >> k, r = b & ((1ULL<<k)-1), half = 1ULL<<(k-1);
+    bool up = false;
+    switch(round){
+        case SPAS_ROUND_TRUNCATE: up = false; break;
+        case SPAS_ROUND_NEAREST_EVEN: up = r > half || (r == half && (e || (q&1))); break;
+        case SPAS_ROUND_NEAREST_AWAY: up = r >= half; break;
+        case SPAS_ROUND_FLOOR: up = neg && (r || e); break;
+        case SPAS_ROUND_CEIL: up = !neg && (r || e); break;
+    }
+    q += up;
+
+    uint64_t limit = neg ? (1ULL<<n) : (1ULL<<n)-1;
+    if(q > limit){
+        clipped++;
+        if(saturate){q = limit;}
+    }
+    return (int64_t)(neg ? 0-q : q);
+}
+
+template<typename T>
+static size_t export_soa(const spas_soa168_t& in, T* out, unsigned bits, spas_round_t round, bool saturate){
+    size_t clipped = 0;
+    for(size_t i=0; i<in.size(); i++){
+        out[i] = (T)export_word(in.sign[i], in.big[i], in.small[i], bits, round, saturate, clipped);
+    }
+    return clipped;
+}
+
+template<typename T>
+static size_t export_aos(const spas_fract168_t* in, size_t n, T* out, unsigned bits, spas_round_t round, bool saturate){
+    size_t clipped = 0;
+    for(size_t i=0; i<n; i++){
+        out[i] = (T)export_word(in[i].sign, in[i].big, in[i].small, bits, round, saturate, clipped);
+    }
+    return clipped;
+}
+
+size_t spas_to_q15(const spas_soa168_t& in, int16_t* out, spas_round_t round, bool saturate){return export_soa(in, out, 15, round, saturate);}
+size_t spas_to_q31(const spas_soa168_t& in, int32_t* out, spas_round_t round, bool saturate){return export_soa(in, out, 31, round, saturate);}
+size_t spas_to_q63(const spas_soa168_t& in, int64_t* out, spas_round_t round, bool saturate){return export_soa(in, out, 63, round, saturate);}
+size_t spas_to_q15(const spas_fract168_t* in, size_t n, int16_t* out, spas_round_t round, bool saturate){return export_aos(in, n, out, 15, round, saturate);}
+size_t spas_to_q31(const spas_fract168_t* in, size_t n, int32_t* out, spas_round_t round, bool saturate){return export_aos(in, n, out, 31, round, saturate);}
+size_t spas_to_q63(const spas_fract168_t* in, size_t n, int64_t* out, spas_round_t round, bool saturate){return export_aos(in, n, out, 63, round, saturate);}
@@ -0,0 +1,35 @@
+#ifndef spas_qformat168
+#define spas_qformat168
+
+#include "spas_soa168.hpp"
+
+// Bulk conversion between Q15/Q31/Q63 fixed point and spas_fract168_t, without the detour through double
+// A Qn word v stands for v / 2^n, so every word except INT_MIN (-1.0) is imported exactly
+// INT_MIN saturates to the closest representable fraction -(1-2^-128)
+
+// Rounding applied when export drops bits below 2^-n
+enum spas_round_t{
+    SPAS_ROUND_TRUNCATE, // Toward zero
+    SPAS_ROUND_NEAREST_EVEN, // Nearest, ties to even
+    SPAS_ROUND_NEAREST_AWAY, // Nearest, ties away from zero
+    SPAS_ROUND_FLOOR, // Toward negative infinity
+    SPAS_ROUND_CEIL // Toward positive infinity
+};
+
+// Import n words into out, out is resized to n
+void spas_from_q15(const int16_t* in, size_t n, spas_soa168_t& out);
+void spas_from_q31(const int32_t* in, size_t n, spas_soa168_t& out);
+void spas_from_q63(const int64_t* in, size_t n, spas_soa168_t& out);
+void spas_from_q15(const int16_t* in, size_t n, spas_fract168_t* out);
+void spas_from_q31(const int32_t* in, size_t n, spas_fract168_t* out);
+void spas_from_q63(const int64_t* in, size_t n, spas_fract168_t* out);
+
+// Export in.size() or n fractions into out, return the number of words that rounded out of range
+// Out of range words are clamped when saturate is set, otherwise they wrap around like two's complement
+size_t spas_to_q15(const spas_soa168_t& in, int16_t* out, spas_round_t round = SPAS_ROUND_NEAREST_EVEN, bool saturate = true);
+size_t spas_to_q31(const spas_soa168_t& in, int32_t* out, spas_round_t round = SPAS_ROUND_NEAREST_EVEN, bool saturate = true);
+size_t spas_to_q63(const spas_soa168_t& in, int64_t* out, spas_round_t round = SPAS_ROUND_NEAREST_EVEN, bool saturate = true);
+size_t spas_to_q15(const spas_fract168_t* in, size_t n, int16_t* out, spas_round_t round = SPAS_ROUND_NEAREST_EVEN, bool saturate = true);
+size_t spas_to_q31(const spas_fract168_t* in, size_t n, int32_t* out, spas_round_t round = SPAS_ROUND_NEAREST_EVEN, bool saturate = true);
+size_t spas_to_q63(const spas_fract168_t* in, size_t n, int64_t* out, spas_round_t round = SPAS_ROUND_NEAREST_EVEN, bool saturate = true);
+#endif
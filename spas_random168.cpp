@@ -0,0 +1,197 @@
+#include "spas_random168.hpp"
+#include "spas_cpu.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+static const uint64_t JUMP[4] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+static const uint64_t LONG_JUMP[4] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635};
+
+static inline uint64_t rotl(uint64_t x, int k){
+    return (x << k) | (x >> (64-k));
+}
+
+static uint64_t splitmix64(uint64_t& x){
+    uint64_t z = (x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+// Constructors
+spas_rng168_t::spas_rng168_t(uint64_t seed){
+    for(int k=0; k<4; k++){
+        this->s[k][0] = splitmix64(seed);
+    }
+    for(int lane=1; lane<4; lane++){
+        for(int k=0; k<4; k++){
+            this->s[k][lane] = this->s[k][lane-1];
+        }
+        this->jump_lane(lane, JUMP);
+    }
+}
+
+uint64_t spas_rng168_t::next_lane(int lane){
+    uint64_t (&s)[4][4] = this->s;
+    uint64_t result = rotl(s[1][lane]*5, 7)*9;
+    uint64_t t = s[1][lane] << 17;
+    s[2][lane] ^= s[0][lane];
+    s[3][lane] ^= s[1][lane];
+    s[1][lane] ^= s[2][lane];
+    s[0][lane] ^= s[3][lane];
+    s[2][lane] ^= t;
+    s[3][lane] = rotl(s[3][lane], 45);
+    return result;
+}
+
+void spas_rng168_t::jump_lane(int lane, const uint64_t poly[4]){
+    uint64_t t[4] = {0, 0, 0, 0};
+    for(int i=0; i<4; i++){
+        for(int b=0; b<64; b++){
+            if(poly[i] & (1ULL << b)){
+                for(int k=0; k<4; k++){
+                    t[k] ^= this->s[k][lane];
+                }
+            }
+            this->next_lane(lane);
+        }
+    }
+    for(int k=0; k<4; k++){
+        this->s[k][lane] = t[k];
+    }
+}
+
+void spas_rng168_t::long_jump(){
+    for(int lane=0; lane<4; lane++){
+        this->jump_lane(lane, LONG_JUMP);
+    }
+}
+
+spas_rng168_t spas_rng168_t::split(){
+    spas_rng168_t t = *this;
+    this->long_jump();
+    return t;
+}
+
+// Stepping
+static void steps_generic(uint64_t (&s)[4][4], uint64_t* out, size_t count){
+    for(size_t i=0; i<count; i++){
+        for(int lane=0; lane<4; lane++){
+            out[4*i+lane] = rotl(s[1][lane]*5, 7)*9;
+            uint64_t t = s[1][lane] << 17;
+            s[2][lane] ^= s[0][lane];
+            s[3][lane] ^= s[1][lane];
+            s[1][lane] ^= s[2][lane];
+            s[0][lane] ^= s[3][lane];
+            s[2][lane] ^= t;
+            s[3][lane] = rotl(s[3][lane], 45);
+        }
+    }
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2")))
+static inline __m256i rotl_avx2(__m256i x, int k){
+    return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64-k));
+}
+
+// AVX2 has no 64 bit multiply, *5 and *9 are done with shifts and adds
+__attribute__((target("avx2")))
+static void steps_avx2(uint64_t (&s)[4][4], uint64_t* out, size_t count){
+    __m256i s0 = _mm256_loadu_si256((const __m256i*)s[0]);
+    __m256i s1 = _mm256_loadu_si256((const __m256i*)s[1]);
+    __m256i s2 = _mm256_loadu_si256((const __m256i*)s[2]);
+    __m256i s3 = _mm256_loadu_si256((const __m256i*)s[3]);
+    for(size_t i=0; i<count; i++){
+        __m256i x = _mm256_add_epi64(_mm256_slli_epi64(s1, 2), s1);
+        x = rotl_avx2(x, 7);
+        x = _mm256_add_epi64(_mm256_slli_epi64(x, 3), x);
+        _mm256_storeu_si256((__m256i*)(out+4*i), x);
+
+        __m256i t = _mm256_slli_epi64(s1, 17);
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = rotl_avx2(s3, 45);
+    }
+    _mm256_storeu_si256((__m256i*)s[0], s0);
+    _mm256_storeu_si256((__m256i*)s[1], s1);
+    _mm256_storeu_si256((__m256i*)s[2], s2);
+    _mm256_storeu_si256((__m256i*)s[3], s3);
+}
+#endif
+
+void spas_rng168_t::steps(uint64_t* out, size_t count){
+#if defined(__x86_64__)
+    if(spas_cpu_features().avx2){
+        steps_avx2(this->s, out, count);
+        return;
+    }
+#endif
+    steps_generic(this->s, out, count);
+}
+
+// Output
+void spas_rng168_t::words(uint64_t* out, size_t n){
+    size_t full = n/4;
+    this->steps(out, full);
+    if(n%4){
+        uint64_t tail[4];
+        this->steps(tail, 1);
+        for(size_t i=0; i<n%4; i++){
+            out[4*full+i] = tail[i];
+        }
+    }
+}
+
+void spas_rng168_t::uniform(spas_soa168_t& out, size_t n, bool with_sign){
+    const size_t GROUPS = 64; // Groups of 4 samples generated per chunk
+    uint64_t w[3*4*GROUPS];
+    out.resize(n);
+
+    for(size_t base=0; base<n; base+=4*GROUPS){
+        size_t groups = (n-base+3)/4;
+        if(groups > GROUPS){groups = GROUPS;}
+        this->steps(w, 3*groups);
+
+        // Sample j of group g takes big, the first word below big and a fill word from the 3 steps of g
+        for(size_t g=0; g<groups; g++){
+            const uint64_t* w0 = w+12*g;
+            const uint64_t* w1 = w0+4;
+            const uint64_t* w2 = w0+8;
+            for(int lane=0; lane<4; lane++){
+                size_t i = base+4*g+lane;
+                if(i >= n){break;}
+
+                uint64_t small = w1[lane], fill = w2[lane];
+                uint64_t offset = 0;
+                while(!small){ // Probability 2^-64, the lane keeps drawing until a one shows up
+                    offset += 64;
+                    small = this->next_lane(lane);
+                    fill = this->next_lane(lane);
+                }
+                unsigned long c = __builtin_clzll(small);
+                if(c){
+                    small = (small << c) | (fill >> (64-c));
+                }
+                offset += c;
+                if(offset > UINT32_MAX){ // Too deep for small, the sample is big alone
+                    small = 0;
+                    offset = 0;
+                }
+
+                unsigned char sign = 0;
+                if(with_sign && (fill & 1)){
+                    sign = w0[lane] ? 0b1001 : 0b0001;
+                }
+                out.sign[i] = small ? sign : (sign & 0b1000);
+                out.big[i] = w0[lane];
+                out.small[i] = small;
+                out.offset[i] = (uint32_t)offset;
+            }
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef spas_random168
+#define spas_random168
+
+#include "spas_soa168.hpp"
+
+// Bulk generator of uniform fractions, made of 4 interleaved xoshiro256** lanes spaced 2^128 steps apart
+// The lanes step together, so the AVX2 path and the portable path produce the same sequence
+class spas_rng168_t{
+    public:
+        uint64_t s[4][4]; // s[k][lane] is the k-th state word of each lane
+
+        // Constructor seeding lane 0 through splitmix64, the other lanes are jumps of lane 0
+        explicit spas_rng168_t(uint64_t seed);
+
+        // Fill out with n raw 64 bit words
+        void words(uint64_t* out, size_t n);
+        // Fill out with n fractions uniform over [0.0, 1.0) or (-1.0, 1.0) when with_sign is set
+        // Every bit of big and small is random, offset follows the leading zeros below big like a real number would
+        void uniform(spas_soa168_t& out, size_t n, bool with_sign = false);
+
+        // Advance every lane by 2^192 steps
+        void long_jump();
+        // Return a generator for another thread and move this one to the next non-overlapping stream
+        spas_rng168_t split();
+
+    private:
+        // Generate count steps of all 4 lanes into out, lane words of one step are contiguous
+        void steps(uint64_t* out, size_t count);
+        // Step a single lane, only for the rare samples needing more than 3 words
+        uint64_t next_lane(int lane);
+        // Apply a xoshiro256 jump polynomial to one lane
+        void jump_lane(int lane, const uint64_t poly[4]);
+};
+#endif
@@ -0,0 +1,88 @@
+#include "spas_soa168.hpp"
+
+// Constructors
+spas_soa168_t::spas_soa168_t(){
+}
+
+spas_soa168_t::spas_soa168_t(size_t n){
+    this->resize(n);
+}
+
+size_t spas_soa168_t::size() const{
+    return this->big.size();
+}
+
+void spas_soa168_t::resize(size_t n){
+    this->sign.resize(n, 0);
+    this->big.resize(n, 0);
+    this->small.resize(n, 0);
+    this->offset.resize(n, 0);
+}
+
+void spas_soa168_t::push_back(const spas_fract168_t& t){
+    this->sign.push_back(t.sign);
+    this->big.push_back(t.big);
+    this->small.push_back(t.small);
+    this->offset.push_back(t.offset);
+}
+
+spas_fract168_t spas_soa168_t::get(size_t i) const{
+    return spas_fract168_t(this->sign[i], this->big[i], this->offset[i], this->small[i]);
+}
+
+void spas_soa168_t::set(size_t i, const spas_fract168_t& t){
+    this->sign[i] = t.sign;
+    this->big[i] = t.big;
+    this->small[i] = t.small;
+    this->offset[i] = t.offset;
+}
+
+// Views
+spas_soa168_view_t::spas_soa168_view_t(const unsigned char* sign, const uint64_t* big, const uint64_t* small, const uint32_t* offset, size_t n){
+    this->sign = sign;
+    this->big = big;
+    this->small = small;
+    this->offset = offset;
+    this->n = n;
+}
+
+spas_soa168_view_t::spas_soa168_view_t(const spas_soa168_t& t) : spas_soa168_view_t(t.sign.data(), t.big.data(), t.small.data(), t.offset.data(), t.size()){
+}
+
+size_t spas_soa168_view_t::size() const{
+    return this->n;
+}
+
+spas_fract168_t spas_soa168_view_t::get(size_t i) const{
+    return spas_fract168_t(this->sign[i], this->big[i], this->offset[i], this->small[i]);
+}
+
+spas_soa168_span_t::spas_soa168_span_t(unsigned char* sign, uint64_t* big, uint64_t* small, uint32_t* offset, size_t n){
+    this->sign = sign;
+    this->big = big;
+    this->small = small;
+    this->offset = offset;
+    this->n = n;
+}
+
+spas_soa168_span_t::spas_soa168_span_t(spas_soa168_t& t) : spas_soa168_span_t(t.sign.data(), t.big.data(), t.small.data(), t.offset.data(), t.size()){
+}
+
+size_t spas_soa168_span_t::size() const{
+    return this->n;
+}
+
+spas_fract168_t spas_soa168_span_t::get(size_t i) const{
+    return spas_fract168_t(this->sign[i], this->big[i], this->offset[i], this->small[i]);
+}
+
+void spas_soa168_span_t::set(size_t i, const spas_fract168_t& t) const{
+    this->sign[i] = t.sign;
+    this->big[i] = t.big;
+    this->small[i] = t.small;
+    this->offset[i] = t.offset;
+}
+
+spas_soa168_span_t::operator spas_soa168_view_t() const{
+    return spas_soa168_view_t(this->sign, this->big, this->small, this->offset, this->n);
+}
@@ -0,0 +1,69 @@
+#ifndef spas_soa168
+#define spas_soa168
+
+#include <vector>
+#include "spas_fract168.hpp"
+
+// Structure of arrays holding a series of spas_fract168_t, each field is stored contiguously for the batch kernels
+class spas_soa168_t{
+    public:
+        std::vector<unsigned char> sign; // Same layout as spas_fract168_t::sign
+        std::vector<uint64_t> big;
+        std::vector<uint64_t> small;
+        std::vector<uint32_t> offset;
+
+        // Empty constructor
+        spas_soa168_t();
+        // Constructor for n zero fractions
+        explicit spas_soa168_t(size_t n);
+
+        size_t size() const;
+        // Resize every field, new fractions are zero
+        void resize(size_t n);
+        void push_back(const spas_fract168_t& t);
+
+        // Return the i-th fraction
+        spas_fract168_t get(size_t i) const;
+        // Overwrite the i-th fraction
+        void set(size_t i, const spas_fract168_t& t);
+};
+
+// Non-owning read-only view of n fractions laid out like spas_soa168_t, over memory that outlives the view
+// e.g. a spas_soa168_t, which converts implicitly, or a mapping shared with another process
+class spas_soa168_view_t{
+    public:
+        const unsigned char* sign;
+        const uint64_t* big;
+        const uint64_t* small;
+        const uint32_t* offset;
+        size_t n;
+
+        // Constructor from the field arrays
+        spas_soa168_view_t(const unsigned char* sign, const uint64_t* big, const uint64_t* small, const uint32_t* offset, size_t n);
+        // View of every fraction of t, invalidated when t is resized
+        spas_soa168_view_t(const spas_soa168_t& t);
+
+        size_t size() const;
+        spas_fract168_t get(size_t i) const;
+};
+
+// Non-owning writable view, same rules as spas_soa168_view_t
+class spas_soa168_span_t{
+    public:
+        unsigned char* sign;
+        uint64_t* big;
+        uint64_t* small;
+        uint32_t* offset;
+        size_t n;
+
+        // Constructor from the field arrays
+        spas_soa168_span_t(unsigned char* sign, uint64_t* big, uint64_t* small, uint32_t* offset, size_t n);
+        // View of every fraction of t, invalidated when t is resized
+        spas_soa168_span_t(spas_soa168_t& t);
+
+        size_t size() const;
+        spas_fract168_t get(size_t i) const;
+        void set(size_t i, const spas_fract168_t& t) const;
+        operator spas_soa168_view_t() const;
+};
+#endif